@@ -155,18 +155,204 @@ image.toGbitmap = function(pixels, width, height) {
   var gbitmap = {
     width: width,
     height: height,
+    format: image.formats['1bit'],
+    rowBytes: growBytes,
     pixels: gpixels,
   };
 
   return gbitmap;
 };
 
+image.formats = {
+  '1bit': 0,
+  '8bit': 1,
+  '1bitPalette': 2,
+  '2bitPalette': 3,
+  '4bitPalette': 4,
+};
+
+/**
+ * The largest mean squared error per channel, in 2-bit color steps, that a palettized image may
+ * have compared to its 8-bit form. Images that exceed it at 16 colors are sent as 8-bit.
+ */
+image.paletteErrorThreshold = 0.05;
+
+var toColor8 = function(pixels, pos) {
+  return ((pixels[pos + 3] >> 6) << 6) |
+         ((pixels[pos + 0] >> 6) << 4) |
+         ((pixels[pos + 1] >> 6) << 2) |
+         ((pixels[pos + 2] >> 6));
+};
+
+var getColor8Distance = function(a, b) {
+  var distance = 0;
+  for (var shift = 0; shift < 8; shift += 2) {
+    var delta = ((a >> shift) & 3) - ((b >> shift) & 3);
+    distance += delta * delta;
+  }
+  return distance;
+};
+
+var getNearestColor = function(palette, color) {
+  var nearest = 0;
+  var nearestDistance = Infinity;
+  for (var i = 0, ii = palette.length; i < ii; ++i) {
+    var distance = getColor8Distance(palette[i], color);
+    if (distance < nearestDistance) {
+      nearest = i;
+      nearestDistance = distance;
+    }
+  }
+  return nearest;
+};
+
+/**
+ * Chooses up to numColors colors for a histogram of 8-bit colors.
+ * The most frequent colors seed a few rounds of k-means refinement in 2-bit channel space.
+ * Returns the palette and the mean squared error per channel.
+ */
+var makePalette = function(histogram, numColors) {
+  var colors = Object.keys(histogram).map(Number);
+  colors.sort(function(a, b) { return histogram[b] - histogram[a]; });
+  var palette = colors.slice(0, numColors);
+  var numRounds = 4;
+  var total = 0;
+  var error = 0;
+  for (var round = 0; round < numRounds; ++round) {
+    var sums = palette.map(function() { return [0, 0, 0, 0, 0]; });
+    total = 0;
+    error = 0;
+    for (var i = 0, ii = colors.length; i < ii; ++i) {
+      var color = colors[i];
+      var count = histogram[color];
+      var nearest = getNearestColor(palette, color);
+      var sum = sums[nearest];
+      for (var j = 0; j < 4; ++j) {
+        sum[j] += ((color >> (j * 2)) & 3) * count;
+      }
+      sum[4] += count;
+      total += count;
+      error += getColor8Distance(palette[nearest], color) * count;
+    }
+    // The error is measured against the current palette, so the last round keeps it unchanged
+    if (colors.length <= numColors || round === numRounds - 1) { break; }
+    palette = sums.map(function(sum, k) {
+      if (!sum[4]) { return palette[k]; }
+      var color = 0;
+      for (var j = 0; j < 4; ++j) {
+        color |= Math.round(sum[j] / sum[4]) << (j * 2);
+      }
+      return color;
+    });
+  }
+  return { palette: palette, error: total ? error / (total * 4) : 0 };
+};
+
+var toPixelBytes = function(indices, width, height, bits) {
+  var rowBytes = Math.ceil(width * bits / 8);
+  var pixelsPerByte = 8 / bits;
+  var bytes = [];
+  for (var i = 0, ii = height * rowBytes; i < ii; ++i) {
+    bytes[i] = 0;
+  }
+  for (var y = 0; y < height; ++y) {
+    for (var x = 0; x < width; ++x) {
+      var bytePos = y * rowBytes + Math.floor(x / pixelsPerByte);
+      var shift = 8 - bits * (x % pixelsPerByte + 1);
+      bytes[bytePos] |= indices[y * width + x] << shift;
+    }
+  }
+  return bytes;
+};
+
+/**
+ * Converts RGBA pixels to the smallest color bitmap that meets paletteErrorThreshold.
+ * Palettized bitmaps carry their palette in front of the pixel rows.
+ */
+image.toColorGbitmap = function(pixels, width, height) {
+  var colors = [];
+  var histogram = {};
+  for (var i = 0, ii = width * height; i < ii; ++i) {
+    var color = toColor8(pixels, i * 4);
+    colors[i] = color;
+    histogram[color] = (histogram[color] || 0) + 1;
+  }
+
+  var gbitmap = {
+    width: width,
+    height: height,
+  };
+
+  var paletteBits = [1, 2, 4];
+  for (var k = 0; k < paletteBits.length; ++k) {
+    var bits = paletteBits[k];
+    var numColors = 1 << bits;
+    var result = makePalette(histogram, numColors);
+    if (result.error > image.paletteErrorThreshold) {
+      continue;
+    }
+    var palette = result.palette;
+    while (palette.length < numColors) {
+      palette.push(0);
+    }
+    var indices = colors.map(getNearestColor.bind(null, palette));
+    gbitmap.format = image.formats[bits + 'bitPalette'];
+    gbitmap.rowBytes = Math.ceil(width * bits / 8);
+    gbitmap.pixels = palette.concat(toPixelBytes(indices, width, height, bits));
+    return gbitmap;
+  }
+
+  gbitmap.format = image.formats['8bit'];
+  gbitmap.rowBytes = width;
+  gbitmap.pixels = colors;
+  return gbitmap;
+};
+
+/**
+ * Finds the row ranges that differ between two bitmaps of the same shape as [firstRow, numRows]
+ * pairs. Returns undefined if the size, format or palette changed and every row must be sent.
+ */
+image.diffRows = function(previous, gbitmap) {
+  var rowBytes = gbitmap.rowBytes;
+  if (!previous || !rowBytes || previous.rowBytes !== rowBytes ||
+      previous.width !== gbitmap.width || previous.height !== gbitmap.height ||
+      previous.format !== gbitmap.format ||
+      previous.pixels.length !== gbitmap.pixels.length) {
+    return;
+  }
+  var paletteLength = gbitmap.pixels.length - gbitmap.height * rowBytes;
+  var i;
+  for (i = 0; i < paletteLength; ++i) {
+    if (previous.pixels[i] !== gbitmap.pixels[i]) { return; }
+  }
+  var ranges = [];
+  var range;
+  for (var y = 0; y < gbitmap.height; ++y) {
+    var start = paletteLength + y * rowBytes;
+    var isChanged = false;
+    for (i = start; i < start + rowBytes && !isChanged; ++i) {
+      isChanged = previous.pixels[i] !== gbitmap.pixels[i];
+    }
+    if (!isChanged) {
+      range = null;
+    } else if (range) {
+      range[1]++;
+    } else {
+      ranges.push(range = [y, 1]);
+    }
+  }
+  return ranges;
+};
+
 image.load = function(img, callback) {
   PNG.load(img.url, function(png) {
     var pixels = png.decode();
     var width = png.width;
     var height = png.height;
-    image.greyscale(pixels, width, height);
+    var isColor = img.color && !img.dither;
+    if (!isColor) {
+      image.greyscale(pixels, width, height);
+    }
     if (img.width) {
       if (!img.height) {
         img.height = parseInt(height * (img.width / width));
@@ -184,11 +370,15 @@ image.load = function(img, callback) {
       width = img.width;
       height = img.height;
     }
-    if (img.dither) {
-      var dithers = image.dithers[img.dither];
-      image.dither(pixels, width, height, dithers);
+    if (isColor) {
+      img.gbitmap = image.toColorGbitmap(pixels, width, height);
+    } else {
+      if (img.dither) {
+        var dithers = image.dithers[img.dither];
+        image.dither(pixels, width, height, dithers);
+      }
+      img.gbitmap = image.toGbitmap(pixels, width, height);
     }
-    img.gbitmap = image.toGbitmap(pixels, width, height);
     if (callback) {
       callback(img);
     }
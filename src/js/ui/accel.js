@@ -20,6 +20,11 @@ Accel.init = function() {
     samples: 25,
     subscribe: false,
     subscribeMode: 'auto',
+    features: {},
+    window: 25,
+    hop: 25,
+    filters: [],
+    gestures: {},
     listeners: [],
   };
 };
@@ -27,6 +32,8 @@ Accel.init = function() {
 Accel.onAddHandler = function(type, subtype) {
   if (type === 'data') {
     Accel.autoSubscribe();
+  } else if (type === 'tap') {
+    Accel.autoConfig();
   }
 };
 
@@ -45,6 +52,15 @@ var accelDataListenerCount = function() {
   return count;
 };
 
+/**
+ * Pebble starts the accelerometer, and with it tap events, once it is first configured.
+ */
+Accel.autoConfig = function() {
+  if (!state.configured) {
+    return Accel.config({});
+  }
+};
+
 Accel.autoSubscribe = function() {
   if (state.subscribeMode !== 'auto') { return; }
   var subscribe = (accelDataListenerCount() > 0);
@@ -61,6 +77,11 @@ Accel.autoSubscribe = function() {
  * @property {number} [rate] - The rate accelerometer data points are generated in hertz. Valid values are 10, 25, 50, and 100. Initializes as 100.
  * @property {number} [samples] - The number of accelerometer data points to accumulate in a batch before calling the event handler. Valid values are 1 to 25 inclusive. Initializes as 25.
  * @property {boolean} [subscribe] - Whether to subscribe to accelerometer data events. {@link simply.accelPeek} cannot be used when subscribed. Simply.js will automatically (un)subscribe for you depending on the amount of accelData handlers registered.
+ * @property {object} [features] - The features the watch computes over each window of samples, for example `{ steps: true }`. Valid features are magnitude, mean, variance, peaks, zeroCrossings and steps. Initializes with none.
+ * @property {number} [window] - The number of samples the features are computed over. Valid values are 2 to 128 inclusive. Initializes as 25.
+ * @property {number} [hop] - The number of new samples between two feature events. Initializes as 25.
+ * @property {object} [gestures] - The gestures the watch recognizes and reports as accelGesture events, for example `{ shake: true }`. Valid gestures are shake, flick, tilt and still. Initializes with none.
+ * @property {object[]} [filters] - Up to four filters the watch applies in order to data samples before sending them. Each filter has a type of 'ema' with an alpha between 0 and 1, 'lowpass' or 'highpass' with a cutoff in hertz and an optional q, or 'decimate' with an integer factor. Initializes with none.
  */
 
 /**
@@ -75,6 +96,11 @@ Accel.config = function(opt, auto) {
       rate: state.rate,
       samples: state.samples,
       subscribe: state.subscribe,
+      features: state.features,
+      window: state.window,
+      hop: state.hop,
+      filters: state.filters,
+      gestures: state.gestures,
     };
   } else if (typeof opt === 'boolean') {
     opt = { subscribe: opt };
@@ -85,6 +111,7 @@ Accel.config = function(opt, auto) {
     }
     state[k] = opt[k];
   }
+  state.configured = true;
   return simply.impl.accelConfig(Accel.config());
 };
 
@@ -119,6 +146,27 @@ Accel.emitAccelTap = function(axis, direction) {
   Accel.emit('tap', axis, e);
 };
 
+/**
+ * Simply.js accel gesture event.
+ * Use the event type 'accelGesture' to subscribe to these events.
+ * @typedef simply.accelGestureEvent
+ * @property {string} gesture - The gesture: 'shake', 'flick', 'tilt' or 'still'. This is also the event subtype.
+ * @property {string} axis - The axis of a flick or tilt: 'x' or 'y'.
+ * @property {number} direction - The direction of a flick or tilt along the axis: 1 or -1, or 0 when a tilt ends.
+ */
+
+Accel.emitAccelGesture = function(gesture, axis, direction) {
+  var e = {
+    gesture: gesture,
+    axis: axis,
+    direction: direction,
+  };
+  if (Window.emit('accelGesture', gesture, e) === false) {
+    return false;
+  }
+  Accel.emit('gesture', gesture, e);
+};
+
 /**
  * Simply.js accel data point.
  * Typical values for gravity is around -1000 on the z axis.
@@ -137,13 +185,15 @@ Accel.emitAccelTap = function(axis, direction) {
  * @property {number} samples - The number of accelerometer samples in this event.
  * @property {simply.accelPoint} accel - The first accel in the batch. This is provided for convenience.
  * @property {simply.accelPoint[]} accels - The accelerometer samples in an array.
+ * @property {number} dropped - The number of samples dropped by the watch since subscribing because they could not be sent in time.
  */
 
-Accel.emitAccelData = function(accels, callback) {
+Accel.emitAccelData = function(accels, callback, dropped) {
   var e = {
     samples: accels.length,
     accel: accels[0],
     accels: accels,
+    dropped: dropped || 0,
   };
   if (callback) {
     return callback(e);
@@ -154,4 +204,26 @@ Accel.emitAccelData = function(accels, callback) {
   Accel.emit('data', e);
 };
 
+/**
+ * Simply.js accel features event.
+ * Use the event type 'accelFeatures' to subscribe to these events. Only the features enabled with
+ * {@link simply.accelConfig} are set. Values are in the milli-g units of {@link simply.accelPoint}.
+ * @typedef simply.accelFeaturesEvent
+ * @property {number} samples - The number of samples in the window.
+ * @property {number} time - The time of the last sample in the window.
+ * @property {object} [magnitude] - The mean and max magnitude of the acceleration.
+ * @property {object} [mean] - The mean x, y and z acceleration.
+ * @property {object} [variance] - The x, y and z variance.
+ * @property {number} [peaks] - The number of magnitude peaks well above the mean.
+ * @property {object} [zeroCrossings] - The number of times x, y and z crossed their mean.
+ * @property {number} [steps] - The number of step-like rises of the magnitude.
+ */
+
+Accel.emitAccelFeatures = function(e) {
+  if (Window.emit('accelFeatures', null, e) === false) {
+    return false;
+  }
+  Accel.emit('features', e);
+};
+
 Accel.init();
@@ -57,11 +57,66 @@ util2.copy(Emitter.prototype, Card.prototype);
 Propable.makeAccessors(accessorProps, Card.prototype);
 
 Card.prototype._prop = function() {
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.card.apply(this, arguments);
   }
 };
 
+Card.prototype._resources = function(images, fonts) {
+  Window.prototype._resources.call(this, images, fonts);
+  imageProps.forEach(function(k) {
+    images.push(this.state[k]);
+  }, this);
+};
+
+Card.prototype._textEdit = function(field, type, start, length, text) {
+  var previous = this.state[field] || '';
+  var value = previous.substr(0, start) + (text || '') + previous.substr(start + length);
+  this.state[field] = value;
+  if (simply.impl.cardTextEdit && WindowStack.isSendable(this)) {
+    simply.impl.cardTextEdit(field, type, previous, start, length, text);
+  } else {
+    this._prop(myutil.toObject(field, value));
+  }
+  return this;
+};
+
+/**
+ * Appends text to a text field. Only the appended text is sent to the watch.
+ */
+Card.prototype.append = function(field, text) {
+  var previous = this.state[field] || '';
+  return this._textEdit(field, 'append', previous.length, 0, text);
+};
+
+/**
+ * Removes the first count characters of a text field.
+ */
+Card.prototype.truncateHead = function(field, count) {
+  return this._textEdit(field, 'truncateHead', 0, count, '');
+};
+
+/**
+ * Replaces length characters at start of a text field with text.
+ */
+Card.prototype.replace = function(field, start, length, text) {
+  var previous = this.state[field] || '';
+  start = Math.max(0, Math.min(start, previous.length));
+  length = Math.max(0, Math.min(length, previous.length - start));
+  return this._textEdit(field, 'replace', start, length, text);
+};
+
+/**
+ * The watch could not apply an edit and emptied the field. The field is set empty here as well so
+ * that later edits use offsets into the same text on both sides.
+ */
+Card.emitTextReset = function(field) {
+  var card = WindowStack.top();
+  if (!(card instanceof Card) || !field) { return; }
+  card.state[field] = '';
+  card._prop(myutil.toObject(field, ''));
+};
+
 Card.prototype._clear = function(flags) {
   flags = myutil.toFlags(flags);
   if (flags === true) {
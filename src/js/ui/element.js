@@ -51,7 +51,7 @@ StageElement.prototype._type = function() {
 };
 
 StageElement.prototype._prop = function(elementDef) {
-  if (this.parent === WindowStack.top()) {
+  if (WindowStack.isSendable(this.parent)) {
     simply.impl.stageElement(this._id(), this._type(), this.state);
   }
 };
@@ -68,7 +68,7 @@ StageElement.prototype.remove = function(broadcast) {
 };
 
 StageElement.prototype._animate = function(animateDef, duration) {
-  if (this.parent === WindowStack.top()) {
+  if (WindowStack.isSendable(this.parent)) {
     simply.impl.stageAnimate(this._id(), this.state,
         animateDef, duration || 400, animateDef.easing || 'easeInOut');
   }
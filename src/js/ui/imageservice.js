@@ -15,6 +15,11 @@ ImageService.init = function() {
   };
 };
 
+var isColorPlatform = function() {
+  var watchInfo = Pebble.getActiveWatchInfo && Pebble.getActiveWatchInfo();
+  return watchInfo ? watchInfo.platform !== 'aplite' : false;
+};
+
 var makeImageHash = function(image) {
   var url = image.url;
   var hashPart = '';
@@ -65,6 +70,7 @@ ImageService.load = function(opt, reset, callback) {
   var hash = makeImageHash(opt);
   var image = state.cache[hash];
   var fetch = false;
+  var previous;
   if (image) {
     if ((opt.width && image.width !== opt.width) ||
         (opt.height && image.height !== opt.height) ||
@@ -77,9 +83,14 @@ ImageService.load = function(opt, reset, callback) {
   }
   if (!image || reset === true) {
     fetch = true;
+    if (image && image.loaded) {
+      // The watch still holds the last sent bitmap, keep the id so that only changed rows are sent
+      previous = image.gbitmap;
+    }
     image = {
-      id: state.nextId++,
+      id: image ? image.id : state.nextId++,
       url: url,
+      color: isColorPlatform(),
     };
   }
   image.width = opt.width;
@@ -88,7 +99,7 @@ ImageService.load = function(opt, reset, callback) {
   image.loaded = true;
   state.cache[hash] = image;
   var onLoad = function() {
-    simply.impl.image(image.id, image.gbitmap);
+    simply.impl.image(image.id, image.gbitmap, previous);
     if (callback) {
       var e = {
         type: 'image',
@@ -115,10 +126,23 @@ ImageService.setRootUrl = function(url) {
  * otherwise a new id is generated for dynamic loading.
  */
 ImageService.resolve = function(opt) {
-  var id = Resource.getId(opt);
+  var id = Resource.getId(opt, 'image');
   return typeof id !== 'undefined' ? id : ImageService.load(opt);
 };
 
+/**
+ * Mark an image as no longer held by the watch so that the next use uploads it again.
+ */
+ImageService.markUnloaded = function(id) {
+  for (var k in state.cache) {
+    var image = state.cache[k];
+    if (image.id === id) {
+      delete image.loaded;
+      return;
+    }
+  }
+};
+
 ImageService.markAllUnloaded = function() {
   for (var k in state.cache) {
     delete state.cache[k].loaded;
@@ -12,5 +12,6 @@ UI.Image = require('ui/image');
 UI.Inverter = require('ui/inverter');
 UI.Vibe = require('ui/vibe');
 UI.Light = require('ui/light');
+UI.InstantLaunch = require('ui/instantlaunch');
 
 module.exports = UI;
@@ -0,0 +1,11 @@
+var simply = require('ui/simply');
+
+var InstantLaunch = module.exports;
+
+InstantLaunch.enable = function() {
+  simply.impl.instantLaunch(true);
+};
+
+InstantLaunch.disable = function() {
+  simply.impl.instantLaunch(false);
+};
@@ -11,6 +11,14 @@ var defaults = {
     highlightBackgroundColor: 'black',
     highlightTextColor: 'white',
   fullscreen: false,
+  offline: false,
+};
+
+var lastDataVersion = 0;
+
+var nextDataVersion = function() {
+  lastDataVersion = lastDataVersion % 0xffff + 1;
+  return lastDataVersion;
 };
 
 var Menu = function(menuDef) {
@@ -36,8 +44,25 @@ Menu.prototype._show = function() {
 
 Menu.prototype._numPreloadItems = 50;
 
+Menu.prototype._resources = function(images, fonts) {
+  Window.prototype._resources.call(this, images, fonts);
+  var sections = this.state.sections;
+  if (!(sections instanceof Array)) { return; }
+  sections.forEach(function(section) {
+    if (section && section.items instanceof Array) {
+      section.items.forEach(function(item) {
+        if (item) { images.push(item.icon); }
+      });
+    }
+  });
+};
+
 Menu.prototype._prop = function(state, clear, pushing) {
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
+    if (clear !== undefined) {
+      // The watch drops an uploaded dataset along with the rest of the menu
+      this._dataKey = null;
+    }
     simply.impl.menu.call(this, state, clear, pushing);
     this._resolveSection(this._selection);
   }
@@ -142,17 +167,64 @@ Menu.prototype._getItem = function(e, create) {
 
 Menu.prototype._resolveMenu = function() {
   var sections = this._getSections(this);
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.menu.call(this, this.state);
+    if (this.state.offline) {
+      this._scheduleData();
+    }
     return true;
   }
 };
 
+Menu.prototype._resolveData = function() {
+  clearTimeout(this._dataTimeout);
+  this._dataTimeout = null;
+  if (!WindowStack.isSendable(this)) { return; }
+  var sections = this._getSections();
+  var data = [];
+  for (var i = 0, ii = sections.length; i < ii; ++i) {
+    var e = { sectionIndex: i };
+    var section = this._getSection(e);
+    data.push({
+      title: section && section.title,
+      items: section ? this._getItems(e) : [],
+    });
+  }
+  // The watch acknowledges each upload. Requests it sent before then were already in flight, while
+  // a request after it means the watch lost the dataset, such as a menu rebuilt from a snapshot.
+  var dataKey = JSON.stringify(data);
+  var isRequested = this._dataRequested;
+  this._dataRequested = false;
+  if (dataKey === this._dataKey && !(isRequested && this._dataAckedVersion === this._dataVersion)) {
+    return true;
+  }
+  this._dataKey = dataKey;
+  this._dataVersion = nextDataVersion();
+  simply.impl.menuData.call(this, data, this._dataVersion);
+  return true;
+};
+
+/**
+ * Offline menus upload the whole dataset at once.
+ * Changes and watch requests made in the same tick are batched into a single upload, and the
+ * dataset is only uploaded again when it changed or the watch asks for it after acknowledging it.
+ */
+Menu.prototype._scheduleData = function() {
+  if (!WindowStack.isSendable(this)) { return false; }
+  if (!this._dataTimeout) {
+    this._dataTimeout = setTimeout(this._resolveData.bind(this), 0);
+  }
+  return true;
+};
+
 Menu.prototype._resolveSection = function(e, clear) {
+  if (this.state.offline) {
+    return this._scheduleData();
+  }
   var section = this._getSection(e);
   if (!section) { return; }
   section.items = this._getItems(e);
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.menuSection.call(this, e.sectionIndex, section, clear);
     var select = this._selection;
     if (select.sectionIndex === e.sectionIndex) {
@@ -163,21 +235,51 @@ Menu.prototype._resolveSection = function(e, clear) {
 };
 
 Menu.prototype._resolveItem = function(e) {
+  if (this.state.offline) {
+    return this._scheduleData();
+  }
   var item = this._getItem(e);
   if (!item) { return; }
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.menuItem.call(this, e.sectionIndex, e.itemIndex, item);
     return true;
   }
 };
 
-Menu.prototype._preloadItems = function(e) {
+/**
+ * Returns whether the items were sent or an upload of the offline dataset was scheduled, and false
+ * if there was nothing to send.
+ */
+Menu.prototype._resolveItems = function(e, itemIndices) {
+  if (this.state.offline) {
+    return this._scheduleData();
+  }
+  if (!WindowStack.isSendable(this)) { return false; }
+  var items = [];
   var select = util2.copy(e);
-  select.itemIndex = Math.max(0, select.itemIndex - Math.floor(this._numPreloadItems / 2));
+  for (var i = 0, ii = itemIndices.length; i < ii; ++i) {
+    select.itemIndex = itemIndices[i];
+    var item = this._getItem(select);
+    if (item) {
+      items.push([select.itemIndex, item]);
+    }
+  }
+  if (!items.length) { return false; }
+  simply.impl.menuItems.call(this, e.sectionIndex, items);
+  return true;
+};
+
+Menu.prototype._preloadItems = function(e) {
+  var start = Math.max(0, e.itemIndex - Math.floor(this._numPreloadItems / 2));
+  var itemIndices = [];
   for (var i = 0; i < this._numPreloadItems; ++i) {
-    this._resolveItem(select);
-    select.itemIndex++;
+    itemIndices.push(start + i);
   }
+  // The watch only caches a few items, send the ones nearest to the selection last
+  itemIndices.sort(function(a, b) {
+    return Math.abs(b - e.itemIndex) - Math.abs(a - e.itemIndex);
+  });
+  this._resolveItems(e, itemIndices);
 };
 
 Menu.prototype._emitSelect = function(e) {
@@ -318,6 +420,7 @@ Menu.emitSection = function(sectionIndex) {
   if (Menu.emit('section', null, e) === false) {
     return false;
   }
+  menu._dataRequested = true;
   menu._resolveSection(e);
 };
 
@@ -334,9 +437,36 @@ Menu.emitItem = function(sectionIndex, itemIndex) {
   if (Menu.emit('item', null, e) === false) {
     return false;
   }
+  menu._dataRequested = true;
   menu._resolveItem(e);
 };
 
+Menu.emitItems = function(sectionIndex, itemIndex, numItems) {
+  var menu = WindowStack.top();
+  if (!(menu instanceof Menu)) { return; }
+  var itemIndices = [];
+  for (var i = itemIndex, ii = itemIndex + numItems; i < ii; ++i) {
+    var e = {
+      menu: menu,
+      sectionIndex: sectionIndex,
+      itemIndex: i,
+    };
+    e.section = menu._getSection(e);
+    e.item = menu._getItem(e);
+    if (Menu.emit('item', null, e) !== false) {
+      itemIndices.push(i);
+    }
+  }
+  menu._dataRequested = true;
+  menu._resolveItems({ sectionIndex: sectionIndex }, itemIndices);
+};
+
+Menu.emitDataAck = function(version) {
+  var menu = WindowStack.top();
+  if (!(menu instanceof Menu) || menu._dataVersion !== version) { return; }
+  menu._dataAckedVersion = version;
+};
+
 Menu.emitSelect = function(type, sectionIndex, itemIndex) {
   var menu = WindowStack.top();
   if (!(menu instanceof Menu)) { return; }
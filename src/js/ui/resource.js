@@ -1,7 +1,14 @@
 var myutil = require('lib/myutil');
 var appinfo = require('appinfo');
 
+/**
+ * The build generates a manifest describing each bundled resource in resource id order, the same
+ * table the watch uses. Fall back to appinfo for builds that do not include it.
+ */
 var resources = (function() {
+  try {
+    return require('resource_manifest');
+  } catch (e) {}
   var resources = appinfo.resources;
   return resources && resources.media || [];
 })();
@@ -10,7 +17,11 @@ var Resource = {};
 
 Resource.items = resources;
 
-Resource.getId = function(opt) {
+/**
+ * Resolve a resource path or name to its bundled resource id.
+ * If a type such as 'image' or 'font' is given, only resources of that type match.
+ */
+Resource.getId = function(opt, type) {
   var path = opt;
   if (typeof opt === 'object') {
     path = opt.url;
@@ -19,10 +30,25 @@ Resource.getId = function(opt) {
   var cname = myutil.toCConstantName(path);
   for (var i = 0, ii = resources.length; i < ii; ++i) {
     var res = resources[i];
+    if (type && res.type && Resource.getType(res) !== type) {
+      continue;
+    }
     if (res.name === cname || res.file === path) {
       return i + 1;
     }
   }
 };
 
+Resource.getType = function(res) {
+  switch (res.type) {
+    case 'png':
+    case 'png-trans':
+    case 'pbi':
+    case 'pbi8':
+    case 'bitmap':
+      return 'image';
+  }
+  return res.type;
+};
+
 module.exports = Resource;
@@ -6,8 +6,10 @@ var Timeline = require('timeline');
 var Resource = require('ui/resource');
 var Accel = require('ui/accel');
 var ImageService = require('ui/imageservice');
+var imagelib = require('lib/image');
 var WindowStack = require('ui/windowstack');
 var Window = require('ui/window');
+var Card = require('ui/card');
 var Menu = require('ui/menu');
 var StageElement = require('ui/element');
 
@@ -33,6 +35,10 @@ var StringType = function(x) {
   return '' + x;
 };
 
+var OptionalStringType = function(x) {
+  return (x === undefined || x === null) ? '' : StringType(x);
+};
+
 var UTF8ByteLength = function(x) {
   return unescape(encodeURIComponent(x)).length;
 };
@@ -143,7 +149,7 @@ var Color = function(color) {
 };
 
 var Font = function(x) {
-  var id = Resource.getId(x);
+  var id = Resource.getId(x, 'font');
   if (id) {
     return id;
   }
@@ -375,6 +381,7 @@ var WindowShowPacket = new struct([
   [Packet, 'packet'],
   ['uint8', 'type', WindowType],
   ['bool', 'pushing', BoolType],
+  ['uint32', 'id'],
 ]);
 
 var WindowHidePacket = new struct([
@@ -390,6 +397,7 @@ var WindowShowEventPacket = new struct([
 var WindowHideEventPacket = new struct([
   [Packet, 'packet'],
   ['uint32', 'id'],
+  ['uint32', 'retainedId'],
 ]);
 
 var WindowPropsPacket = new struct([
@@ -429,9 +437,34 @@ var ImagePacket = new struct([
   ['uint32', 'id'],
   ['int16', 'width'],
   ['int16', 'height'],
+  ['uint8', 'format'],
   ['data', 'pixels'],
 ]);
 
+var ImageBandPacket = new struct([
+  [Packet, 'packet'],
+  ['uint32', 'id'],
+  ['uint16', 'row'],
+  ['uint16', 'rows'],
+  ['data', 'pixels'],
+]);
+
+var ImageUnloadedPacket = new struct([
+  [Packet, 'packet'],
+  ['uint32', 'id'],
+]);
+
+var ResPreloadPacket = new struct([
+  [Packet, 'packet'],
+  ['uint8', 'images'],
+  ['uint8', 'fonts'],
+  ['data', 'ids'],
+]);
+
+var ResPreloadId = new struct([
+  ['uint32', 'id'],
+]);
+
 var CardClearPacket = new struct([
   [Packet, 'packet'],
   ['uint8', 'flags'],
@@ -444,6 +477,28 @@ var CardTextPacket = new struct([
   ['cstring', 'text'],
 ]);
 
+var CardTextEditTypes = [
+  'append',
+  'truncateHead',
+  'replace',
+];
+
+var CardTextEditType = makeArrayType(CardTextEditTypes);
+
+var CardTextEditPacket = new struct([
+  [Packet, 'packet'],
+  ['uint8', 'index', CardTextType],
+  ['uint8', 'type', CardTextEditType],
+  ['uint16', 'start'],
+  ['uint16', 'length'],
+  ['cstring', 'text'],
+]);
+
+var CardTextResetPacket = new struct([
+  [Packet, 'packet'],
+  ['uint8', 'index', CardTextType],
+]);
+
 var CardImagePacket = new struct([
   [Packet, 'packet'],
   ['uint32', 'image', ImageType],
@@ -465,29 +520,93 @@ var LightPacket = new struct([
   ['uint8', 'type', LightType],
 ]);
 
+var InstantLaunchPacket = new struct([
+  [Packet, 'packet'],
+  ['bool', 'enabled', BoolType],
+]);
+
 var AccelPeekPacket = new struct([
   [Packet, 'packet'],
 ]);
 
+var AccelFeatureTypes = [
+  'magnitude',
+  'mean',
+  'variance',
+  'peaks',
+  'zeroCrossings',
+  'steps',
+];
+
+var AccelFeaturesType = makeFlagsType(AccelFeatureTypes);
+
+var AccelGestureTypes = [
+  'shake',
+  'flick',
+  'tilt',
+  'still',
+];
+
+var AccelGesturesType = makeFlagsType(AccelGestureTypes);
+
 var AccelConfigPacket = new struct([
   [Packet, 'packet'],
   ['uint16', 'samples'],
   ['uint8', 'rate'],
   ['bool', 'subscribe', BoolType],
+  ['uint8', 'features', AccelFeaturesType],
+  ['uint16', 'window'],
+  ['uint16', 'hop'],
+  ['uint8', 'gestures', AccelGesturesType],
+  ['uint8', 'numFilters'],
+  ['data', 'filterStages'],
 ]);
 
-var AccelData = new struct([
-  ['int16', 'x'],
-  ['int16', 'y'],
-  ['int16', 'z'],
-  ['bool', 'vibe'],
-  ['uint64', 'time'],
+var AccelFilterTypes = [
+  'none',
+  'ema',
+  'biquad',
+  'decimate',
+];
+
+var AccelFilterType = makeArrayType(AccelFilterTypes);
+
+var AccelFilterStage = new struct([
+  ['uint8', 'type', AccelFilterType],
+  ['int16', 'param0'],
+  ['int16', 'param1'],
+  ['int16', 'param2'],
+  ['int16', 'param3'],
+  ['int16', 'param4'],
 ]);
 
 var AccelDataPacket = new struct([
   [Packet, 'packet'],
   ['bool', 'peek'],
   ['uint8', 'samples'],
+  ['uint8', 'deltaSize'],
+  ['uint32', 'dropped'],
+  ['uint64', 'time'],
+  ['uint16', 'interval'],
+  ['int16', 'x'],
+  ['int16', 'y'],
+  ['int16', 'z'],
+]);
+
+var AccelVibeBits = new struct([
+  ['uint8', 'bits'],
+]);
+
+var AccelDelta8 = new struct([
+  ['int8', 'x'],
+  ['int8', 'y'],
+  ['int8', 'z'],
+]);
+
+var AccelDelta16 = new struct([
+  ['int16', 'x'],
+  ['int16', 'y'],
+  ['int16', 'z'],
 ]);
 
 var AccelTapPacket = new struct([
@@ -496,6 +615,47 @@ var AccelTapPacket = new struct([
   ['int8', 'direction'],
 ]);
 
+var AccelGesturePacket = new struct([
+  [Packet, 'packet'],
+  ['uint8', 'gesture'],
+  ['uint8', 'axis'],
+  ['int8', 'direction'],
+]);
+
+var AccelFeaturesPacket = new struct([
+  [Packet, 'packet'],
+  ['uint8', 'features'],
+  ['uint16', 'samples'],
+  ['uint64', 'time'],
+]);
+
+var AccelMagnitudeFeature = new struct([
+  ['uint16', 'mean'],
+  ['uint16', 'max'],
+]);
+
+var AccelMeanFeature = new struct([
+  ['int16', 'x'],
+  ['int16', 'y'],
+  ['int16', 'z'],
+]);
+
+var AccelVarianceFeature = new struct([
+  ['uint32', 'x'],
+  ['uint32', 'y'],
+  ['uint32', 'z'],
+]);
+
+var AccelCountFeature = new struct([
+  ['uint8', 'count'],
+]);
+
+var AccelAxisCountsFeature = new struct([
+  ['uint8', 'x'],
+  ['uint8', 'y'],
+  ['uint8', 'z'],
+]);
+
 var MenuClearPacket = new struct([
   [Packet, 'packet'],
 ]);
@@ -544,6 +704,54 @@ var MenuGetItemPacket = new struct([
   ['uint16', 'item'],
 ]);
 
+var MenuItemsPacket = new struct([
+  [Packet, 'packet'],
+  ['uint16', 'section'],
+  ['uint16', 'items'],
+  ['data', 'buffer'],
+]);
+
+var MenuItemsEntry = new struct([
+  ['uint16', 'item'],
+  ['uint32', 'icon', ImageType],
+  ['uint16', 'titleLength', EnumerableType],
+  ['uint16', 'subtitleLength', EnumerableType],
+  ['cstring', 'title', StringType],
+  ['cstring', 'subtitle', StringType],
+]);
+
+var MenuGetItemsPacket = new struct([
+  [Packet, 'packet'],
+  ['uint16', 'section'],
+  ['uint16', 'item'],
+  ['uint16', 'items'],
+]);
+
+var MenuDataPacket = new struct([
+  [Packet, 'packet'],
+  ['uint16', 'version'],
+  ['uint16', 'sections'],
+  ['uint16', 'items'],
+  ['data', 'buffer'],
+]);
+
+var MenuDataAckPacket = new struct([
+  [Packet, 'packet'],
+  ['uint16', 'version'],
+]);
+
+var MenuDataSection = new struct([
+  ['uint16', 'firstItem'],
+  ['uint16', 'items'],
+  ['uint16', 'title'],
+]);
+
+var MenuDataItem = new struct([
+  ['uint32', 'icon', ImageType],
+  ['uint16', 'title'],
+  ['uint16', 'subtitle'],
+]);
+
 var MenuSelectionPacket = new struct([
   [Packet, 'packet'],
   ['uint16', 'section'],
@@ -677,16 +885,24 @@ var CommandPackets = [
   ClickPacket,
   LongClickPacket,
   ImagePacket,
+  ImageUnloadedPacket,
+  ImageBandPacket,
+  ResPreloadPacket,
   CardClearPacket,
   CardTextPacket,
+  CardTextEditPacket,
+  CardTextResetPacket,
   CardImagePacket,
   CardStylePacket,
   VibePacket,
   LightPacket,
+  InstantLaunchPacket,
   AccelPeekPacket,
   AccelConfigPacket,
   AccelDataPacket,
   AccelTapPacket,
+  AccelFeaturesPacket,
+  AccelGesturePacket,
   MenuClearPacket,
   MenuClearSectionPacket,
   MenuPropsPacket,
@@ -694,6 +910,10 @@ var CommandPackets = [
   MenuGetSectionPacket,
   MenuItemPacket,
   MenuGetItemPacket,
+  MenuItemsPacket,
+  MenuGetItemsPacket,
+  MenuDataPacket,
+  MenuDataAckPacket,
   MenuSelectionPacket,
   MenuGetSelectionPacket,
   MenuSelectionEventPacket,
@@ -795,19 +1015,21 @@ MessageQueue.prototype.send = function(message) {
   this.cycle();
 };
 
+var toViewByteArray = function(buffer, size) {
+  var byteArray = new Array(size);
+  for (var i = 0; i < size; ++i) {
+    byteArray[i] = buffer.getUint8(i);
+  }
+  return byteArray;
+};
+
 var toByteArray = function(packet) {
   var type = CommandPackets.indexOf(packet);
   var size = Math.max(packet._size, packet._cursor);
   packet.packetType(type);
   packet.packetLength(size);
 
-  var buffer = packet._view;
-  var byteArray = new Array(size);
-  for (var i = 0; i < size; ++i) {
-    byteArray[i] = buffer.getUint8(i);
-  }
-
-  return byteArray;
+  return toViewByteArray(packet._view, size);
 };
 
 /**
@@ -913,8 +1135,83 @@ SimplyPebble.windowActionBar = function(def) {
   SimplyPebble.sendPacket(WindowActionBarPacket);
 };
 
-SimplyPebble.image = function(id, gbitmap) {
-  SimplyPebble.sendPacket(ImagePacket.id(id).prop(gbitmap));
+var sendImageRows = function(id, gbitmap, firstRow, numRows) {
+  var maxSize = state.packetQueue._maxPayloadSize - 1;
+  var rowBytes = gbitmap.rowBytes;
+  var paletteLength = gbitmap.pixels.length - gbitmap.height * rowBytes;
+  var bandRows = Math.max(1, Math.floor((maxSize - ImageBandPacket._size) / rowBytes));
+  for (var row = firstRow, end = firstRow + numRows; row < end; row += bandRows) {
+    var rows = Math.min(bandRows, end - row);
+    var start = paletteLength + row * rowBytes;
+    ImageBandPacket
+      .id(id)
+      .row(row)
+      .rows(rows)
+      .pixels(gbitmap.pixels.slice(start, start + rows * rowBytes));
+    SimplyPebble.sendPacket(ImageBandPacket);
+  }
+};
+
+/**
+ * Sends an image that does not fit in one packet as an allocation followed by bands of rows.
+ * The watch writes each band into the bitmap and draws the rows received so far.
+ * When the watch holds a previous bitmap of the same shape, only the changed rows are sent.
+ */
+SimplyPebble.image = function(id, gbitmap, previous) {
+  var ranges = imagelib.diffRows(previous, gbitmap);
+  if (ranges) {
+    for (var i = 0, ii = ranges.length; i < ii; ++i) {
+      sendImageRows(id, gbitmap, ranges[i][0], ranges[i][1]);
+    }
+    return;
+  }
+  var maxSize = state.packetQueue._maxPayloadSize - 1;
+  var rowBytes = gbitmap.rowBytes;
+  if (!rowBytes || ImagePacket._size + gbitmap.pixels.length <= maxSize) {
+    SimplyPebble.sendPacket(ImagePacket.id(id).prop(gbitmap));
+    return;
+  }
+  var paletteLength = gbitmap.pixels.length - gbitmap.height * rowBytes;
+  ImagePacket
+    .id(id)
+    .width(gbitmap.width)
+    .height(gbitmap.height)
+    .format(gbitmap.format)
+    .pixels(gbitmap.pixels.slice(0, paletteLength));
+  SimplyPebble.sendPacket(ImagePacket);
+  sendImageRows(id, gbitmap, 0, gbitmap.height);
+};
+
+var toBundledIds = function(list, toId) {
+  var ids = [];
+  for (var i = 0, ii = list ? list.length : 0; i < ii && ids.length < 255; ++i) {
+    var id = list[i] ? toId(list[i]) : 0;
+    if (typeof id === 'number' && id > 0 && id <= Resource.items.length && ids.indexOf(id) === -1) {
+      ids.push(id);
+    }
+  }
+  return ids;
+};
+
+/**
+ * Asks the watch to load bundled images and fonts in the background before a window needs them.
+ * Images that are not bundled are uploaded through the image service as usual.
+ */
+SimplyPebble.resPreload = function(images, fonts) {
+  var imageIds = toBundledIds(images, ImageType);
+  var fontIds = toBundledIds(fonts, Font);
+  if (!imageIds.length && !fontIds.length) { return; }
+  var bytes = [];
+  var ids = imageIds.concat(fontIds);
+  for (var i = 0, ii = ids.length; i < ii; ++i) {
+    ResPreloadId.id(ids[i]);
+    Array.prototype.push.apply(bytes, toViewByteArray(ResPreloadId._view, ResPreloadId._size));
+  }
+  ResPreloadPacket
+    .images(imageIds.length)
+    .fonts(fontIds.length)
+    .ids(bytes);
+  SimplyPebble.sendPacket(ResPreloadPacket);
 };
 
 var toClearFlags = function(clear) {
@@ -946,6 +1243,27 @@ SimplyPebble.cardText = function(field, text, color) {
   SimplyPebble.sendPacket(CardTextPacket);
 };
 
+var utf8Length = function(str) {
+  return unescape(encodeURIComponent(str)).length;
+};
+
+/**
+ * Edits a card text field in place instead of sending the whole text again.
+ * The range is given in characters of the previous text and converted to UTF-8 byte offsets.
+ */
+SimplyPebble.cardTextEdit = function(field, type, previous, start, length, text) {
+  previous = previous || '';
+  var byteStart = utf8Length(previous.substr(0, start));
+  var byteLength = utf8Length(previous.substr(start, length));
+  CardTextEditPacket
+    .index(field)
+    .type(type)
+    .start(byteStart)
+    .length(byteLength)
+    .text(text || '');
+  SimplyPebble.sendPacket(CardTextEditPacket);
+};
+
 SimplyPebble.cardImage = function(field, image) {
   SimplyPebble.sendPacket(CardImagePacket.index(field).image(image));
 };
@@ -956,7 +1274,7 @@ SimplyPebble.cardStyle = function(field, style) {
 
 SimplyPebble.card = function(def, clear, pushing) {
   if (arguments.length === 3) {
-    SimplyPebble.windowShow({ type: 'card', pushing: pushing });
+    SimplyPebble.windowShow({ type: 'card', pushing: pushing, id: def.id });
   }
   if (clear !== undefined) {
     SimplyPebble.cardClear(clear);
@@ -985,15 +1303,89 @@ SimplyPebble.light = function(type) {
   SimplyPebble.sendPacket(LightPacket.type(type));
 };
 
+SimplyPebble.instantLaunch = function(enabled) {
+  SimplyPebble.sendPacket(InstantLaunchPacket.enabled(enabled));
+};
+
+/**
+ * A peek that is not answered by then was lost along with its listeners, such as while
+ * disconnected, and no longer holds back later peeks.
+ */
+var ACCEL_PEEK_TIMEOUT_MS = 5000;
+
 var accelListeners = [];
+var accelPeekTimeout = null;
+
+var resetAccelPeek = function() {
+  clearTimeout(accelPeekTimeout);
+  accelPeekTimeout = null;
+  var handlers = accelListeners;
+  accelListeners = [];
+  return handlers;
+};
 
 SimplyPebble.accelPeek = function(callback) {
-  accelListeners.push(callback);
+  // A pending peek answers every listener, so only the first one needs to ask
+  if (accelListeners.push(callback) > 1) { return; }
+  accelPeekTimeout = setTimeout(resetAccelPeek, ACCEL_PEEK_TIMEOUT_MS);
   SimplyPebble.sendPacket(AccelPeekPacket);
 };
 
+var MAX_ACCEL_FILTERS = 4;
+
+var toQ14 = function(x) {
+  return Math.max(-32768, Math.min(32767, Math.round(x * (1 << 14))));
+};
+
+/**
+ * Computes the Q14 coefficients of a second order Butterworth low or high pass filter, following
+ * the Audio EQ Cookbook, normalized so that a0 is one.
+ */
+var toBiquadParams = function(filter, rate) {
+  var w0 = 2 * Math.PI * Math.min(filter.cutoff, rate / 2 - 0.01) / rate;
+  var cos = Math.cos(w0);
+  var alpha = Math.sin(w0) / (2 * (filter.q || Math.SQRT1_2));
+  var a0 = 1 + alpha;
+  var b0 = (filter.type === 'highpass' ? 1 + cos : 1 - cos) / 2;
+  var b1 = filter.type === 'highpass' ? -(1 + cos) : 1 - cos;
+  return [b0, b1, b0, -2 * cos, 1 - alpha].map(function(x) { return toQ14(x / a0); });
+};
+
+var toAccelFilterStages = function(filters, rate) {
+  var bytes = [];
+  filters = (filters || []).slice(0, MAX_ACCEL_FILTERS);
+  for (var i = 0, ii = filters.length; i < ii; ++i) {
+    var filter = filters[i];
+    var params = [0, 0, 0, 0, 0];
+    var type = filter.type;
+    if (type === 'ema') {
+      params[0] = Math.max(1, toQ14(filter.alpha));
+    } else if (type === 'lowpass' || type === 'highpass') {
+      type = 'biquad';
+      params = toBiquadParams(filter, rate);
+    } else if (type === 'decimate') {
+      params[0] = Math.max(1, filter.factor | 0);
+      rate /= params[0];
+    }
+    AccelFilterStage
+      .type(type)
+      .param0(params[0])
+      .param1(params[1])
+      .param2(params[2])
+      .param3(params[3])
+      .param4(params[4]);
+    Array.prototype.push.apply(bytes, toViewByteArray(AccelFilterStage._view, AccelFilterStage._size));
+  }
+  return bytes;
+};
+
 SimplyPebble.accelConfig = function(def) {
-  SimplyPebble.sendPacket(AccelConfigPacket.prop(def));
+  var stages = toAccelFilterStages(def.filters, def.rate);
+  AccelConfigPacket
+    .prop(def)
+    .numFilters(stages.length / AccelFilterStage._size)
+    .filterStages(stages);
+  SimplyPebble.sendPacket(AccelConfigPacket);
 };
 
 SimplyPebble.menuClear = function() {
@@ -1032,6 +1424,98 @@ SimplyPebble.menuItem = function(section, item, def) {
   SimplyPebble.sendPacket(MenuItemPacket);
 };
 
+var toMenuItemsEntry = function(itemIndex, def) {
+  var title = OptionalStringType(def.title);
+  var subtitle = OptionalStringType(def.subtitle);
+  MenuItemsEntry
+    .item(itemIndex)
+    .icon(def.icon)
+    .titleLength(title)
+    .subtitleLength(subtitle)
+    .title(title)
+    .subtitle(subtitle);
+  return toViewByteArray(MenuItemsEntry._view, MenuItemsEntry._cursor);
+};
+
+/**
+ * Sends many items of a section in as few packets as possible.
+ * Each entry of items is a pair [itemIndex, itemDef]. Entries are packed back to back,
+ * and a new packet is started whenever the current one would exceed the payload size.
+ */
+SimplyPebble.menuItems = function(section, items) {
+  var maxSize = state.packetQueue._maxPayloadSize - MenuItemsPacket._size;
+  var buffer = [];
+  var numItems = 0;
+  var flush = function() {
+    if (numItems === 0) { return; }
+    SimplyPebble.sendPacket(MenuItemsPacket.section(section).items(numItems).buffer(buffer));
+    buffer = [];
+    numItems = 0;
+  };
+  for (var i = 0, ii = items.length; i < ii; ++i) {
+    var entry = toMenuItemsEntry(items[i][0], items[i][1]);
+    if (buffer.length + entry.length > maxSize) {
+      flush();
+    }
+    Array.prototype.push.apply(buffer, entry);
+    numItems++;
+  }
+  flush();
+};
+
+var MenuDataNoString = 0xFFFF;
+
+/**
+ * Sends a whole menu as a single dataset that the watch pages through without asking for
+ * sections or items. Strings are deduplicated into one table and referenced by byte offset.
+ */
+SimplyPebble.menuData = function(sections, version) {
+  var sectionBytes = [];
+  var itemBytes = [];
+  var stringBytes = [];
+  var stringOffsets = {};
+  var toStringOffset = function(x) {
+    var str = OptionalStringType(x);
+    if (!str) { return MenuDataNoString; }
+    if (stringOffsets.hasOwnProperty(str)) {
+      return stringOffsets[str];
+    }
+    var offset = stringBytes.length;
+    if (offset >= MenuDataNoString) { return MenuDataNoString; }
+    var utf8 = unescape(encodeURIComponent(str));
+    for (var i = 0, ii = utf8.length; i < ii; ++i) {
+      stringBytes.push(utf8.charCodeAt(i));
+    }
+    stringBytes.push(0);
+    return (stringOffsets[str] = offset);
+  };
+  var numItems = 0;
+  for (var i = 0, ii = sections.length; i < ii; ++i) {
+    var section = sections[i] || {};
+    var items = section.items || [];
+    MenuDataSection
+      .firstItem(numItems)
+      .items(items.length)
+      .title(toStringOffset(section.title));
+    Array.prototype.push.apply(sectionBytes, toViewByteArray(MenuDataSection._view, MenuDataSection._size));
+    for (var j = 0, jj = items.length; j < jj; ++j) {
+      var item = items[j] || {};
+      MenuDataItem
+        .icon(item.icon)
+        .title(toStringOffset(item.title))
+        .subtitle(toStringOffset(item.subtitle));
+      Array.prototype.push.apply(itemBytes, toViewByteArray(MenuDataItem._view, MenuDataItem._size));
+    }
+    numItems += items.length;
+  }
+  MenuDataPacket
+    .version(version)
+    .sections(sections.length)
+    .items(numItems)
+    .buffer(sectionBytes.concat(itemBytes, stringBytes));
+  SimplyPebble.sendPacket(MenuDataPacket);
+};
+
 SimplyPebble.menuSelection = function(section, item, align) {
   if (section === undefined) {
     SimplyPebble.sendPacket(MenuGetSelectionPacket);
@@ -1042,7 +1526,7 @@ SimplyPebble.menuSelection = function(section, item, align) {
 
 SimplyPebble.menu = function(def, clear, pushing) {
   if (arguments.length === 3) {
-    SimplyPebble.windowShow({ type: 'menu', pushing: pushing });
+    SimplyPebble.windowShow({ type: 'menu', pushing: pushing, id: def.id });
   }
   if (clear !== undefined) {
     SimplyPebble.menuClear();
@@ -1133,7 +1617,7 @@ SimplyPebble.stageAnimate = SimplyPebble.elementAnimate;
 
 SimplyPebble.stage = function(def, clear, pushing) {
   if (arguments.length === 3) {
-    SimplyPebble.windowShow({ type: 'window', pushing: pushing });
+    SimplyPebble.windowShow({ type: 'window', pushing: pushing, id: def.id });
   }
   SimplyPebble.windowProps(def);
   if (clear !== undefined) {
@@ -1190,24 +1674,69 @@ SimplyPebble.onWakeupSetResult = function(packet) {
 
 SimplyPebble.onAccelData = function(packet) {
   var samples = packet.samples();
+  var time = packet.time();
+  var interval = packet.interval();
+  var x = packet.x(), y = packet.y(), z = packet.z();
+  var Delta = packet.deltaSize() === 1 ? AccelDelta8 : AccelDelta16;
+  var vibeOffset = packet._offset + packet._size;
+  AccelVibeBits._view = Delta._view = packet._view;
+  Delta._offset = vibeOffset + Math.ceil(samples / 8);
   var accels = [];
-  AccelData._view = packet._view;
-  AccelData._offset = packet._size;
   for (var i = 0; i < samples; ++i) {
-    accels.push(AccelData.prop());
-    AccelData._offset += AccelData._size;
+    if (i > 0) {
+      x += Delta.x();
+      y += Delta.y();
+      z += Delta.z();
+      Delta._offset += Delta._size;
+    }
+    AccelVibeBits._offset = vibeOffset + (i >> 3);
+    accels.push({
+      x: x,
+      y: y,
+      z: z,
+      vibe: (AccelVibeBits.bits() & (1 << (i & 7))) !== 0,
+      time: time + i * interval,
+    });
   }
   if (!packet.peek()) {
-    Accel.emitAccelData(accels);
+    Accel.emitAccelData(accels, null, packet.dropped());
   } else {
-    var handlers = accelListeners;
-    accelListeners = [];
+    var handlers = resetAccelPeek();
     for (var j = 0, jj = handlers.length; j < jj; ++j) {
       Accel.emitAccelData(accels, handlers[j]);
     }
   }
 };
 
+var readAccelXYZ = function(def) {
+  return { x: def.x(), y: def.y(), z: def.z() };
+};
+
+SimplyPebble.onAccelFeatures = function(packet) {
+  var features = packet.features();
+  var offset = packet._offset + packet._size;
+  var e = {
+    samples: packet.samples(),
+    time: packet.time(),
+  };
+  var readNext = function(name, def, read) {
+    if (!(features & (1 << AccelFeatureTypes.indexOf(name)))) { return; }
+    def._view = packet._view;
+    def._offset = offset;
+    e[name] = read(def);
+    offset += def._size;
+  };
+  readNext('magnitude', AccelMagnitudeFeature, function(def) {
+    return { mean: def.mean(), max: def.max() };
+  });
+  readNext('mean', AccelMeanFeature, readAccelXYZ);
+  readNext('variance', AccelVarianceFeature, readAccelXYZ);
+  readNext('peaks', AccelCountFeature, function(def) { return def.count(); });
+  readNext('zeroCrossings', AccelAxisCountsFeature, readAccelXYZ);
+  readNext('steps', AccelCountFeature, function(def) { return def.count(); });
+  Accel.emitAccelFeatures(e);
+};
+
 SimplyPebble.onPacket = function(buffer, offset) {
   Packet._view = buffer;
   Packet._offset = offset;
@@ -1231,8 +1760,13 @@ SimplyPebble.onPacket = function(buffer, offset) {
       Wakeup.emitWakeup(packet.id(), packet.cookie());
       break;
     case WindowHideEventPacket:
-      ImageService.markAllUnloaded();
-      WindowStack.emitHide(packet.id());
+      WindowStack.emitHide(packet.id(), packet.retainedId());
+      break;
+    case ImageUnloadedPacket:
+      ImageService.markUnloaded(packet.id());
+      break;
+    case CardTextResetPacket:
+      Card.emitTextReset(CardTextTypes[packet.index()]);
       break;
     case ClickPacket:
       Window.emitClick('click', ButtonTypes[packet.button()]);
@@ -1246,12 +1780,25 @@ SimplyPebble.onPacket = function(buffer, offset) {
     case AccelTapPacket:
       Accel.emitAccelTap(accelAxes[packet.axis()], packet.direction());
       break;
+    case AccelFeaturesPacket:
+      SimplyPebble.onAccelFeatures(packet);
+      break;
+    case AccelGesturePacket:
+      Accel.emitAccelGesture(AccelGestureTypes[packet.gesture()], accelAxes[packet.axis()],
+        packet.direction());
+      break;
     case MenuGetSectionPacket:
       Menu.emitSection(packet.section());
       break;
     case MenuGetItemPacket:
       Menu.emitItem(packet.section(), packet.item());
       break;
+    case MenuGetItemsPacket:
+      Menu.emitItems(packet.section(), packet.item(), packet.items());
+      break;
+    case MenuDataAckPacket:
+      Menu.emitDataAck(packet.version());
+      break;
     case MenuSelectPacket:
       Menu.emitSelect('menuSelect', packet.section(), packet.item());
       break;
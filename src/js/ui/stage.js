@@ -24,7 +24,7 @@ Stage.prototype._show = function() {
 };
 
 Stage.prototype._prop = function() {
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.stage.apply(this, arguments);
   }
 };
@@ -43,14 +43,14 @@ Stage.prototype.index = function(element) {
 };
 
 Stage.prototype._insert = function(index, element) {
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.stageElement(element._id(), element._type(), element.state, index);
   }
 };
 
 Stage.prototype._remove = function(element, broadcast) {
   if (broadcast === false) { return; }
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.stageRemove(element._id());
   }
 };
@@ -5,6 +5,7 @@ var Accel = require('ui/accel');
 var WindowStack = require('ui/windowstack');
 var Propable = require('ui/propable');
 var Stage = require('ui/stage');
+var ImageService = require('ui/imageservice');
 var simply = require('ui/simply');
 
 var buttons = [
@@ -98,6 +99,44 @@ Window.prototype.show = function() {
   return this;
 };
 
+/**
+ * Collects the images and fonts this window will draw so they can be loaded ahead of time.
+ */
+Window.prototype._resources = function(images, fonts) {
+  var action = this.state.action;
+  if (action && typeof action === 'object') {
+    images.push(action.up, action.select, action.down);
+  }
+  this._items.forEach(function(element) {
+    images.push(element.state.image);
+    fonts.push(element.state.font);
+  });
+};
+
+/**
+ * Called instead of _show when the watch still holds this window from before it was covered.
+ * Only the images the watch has unloaded since then need to be sent again.
+ */
+Window.prototype._restore = function() {
+  var images = [];
+  this._resources(images, []);
+  images.forEach(function(image) {
+    if (typeof image === 'string') {
+      ImageService.resolve(image);
+    }
+  });
+};
+
+Window.prototype.preload = function() {
+  var images = [];
+  var fonts = [];
+  this._resources(images, fonts);
+  if (simply.impl.resPreload) {
+    simply.impl.resPreload(images, fonts);
+  }
+  return this;
+};
+
 Window.prototype._insert = function() {
   if (this._dynamic) {
     Stage.prototype._insert.apply(this, arguments);
@@ -141,7 +180,7 @@ Window.prototype.prop = function(field, value, clear) {
 };
 
 Window.prototype._action = function(actionDef) {
-  if (this === WindowStack.top()) {
+  if (WindowStack.isSendable(this)) {
     simply.impl.windowActionBar(actionDef);
   }
 };
@@ -180,6 +219,8 @@ Window.prototype.onAddHandler = function(type, subtype) {
   }
   if (type === 'accelData') {
     Accel.autoSubscribe();
+  } else if (type === 'accelTap') {
+    Accel.autoConfig();
   }
 };
 
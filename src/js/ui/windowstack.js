@@ -39,9 +39,14 @@ WindowStack.prototype._emitHide = function(item) {
   item.forEachListener(item.onRemoveHandler);
 };
 
-WindowStack.prototype._show = function(item, pushing) {
+WindowStack.prototype._show = function(item, pushing, retained) {
   if (!item) { return; }
-  item._show(pushing);
+  if (retained) {
+    item._restore();
+  } else {
+    item._show(pushing);
+  }
+  item._synced = true;
   this._emitShow(item);
 };
 
@@ -51,6 +56,16 @@ WindowStack.prototype._hide = function(item, broadcast) {
   item._hide(broadcast);
 };
 
+/**
+ * Whether changes to a window can be sent to the watch. Only the top window can be updated,
+ * any other window that changes will be sent in full the next time it is shown.
+ */
+WindowStack.prototype.isSendable = function(item) {
+  if (item && item === this.top()) { return true; }
+  if (item) { item._synced = false; }
+  return false;
+};
+
 WindowStack.prototype.at = function(index) {
   return this._items[index];
 };
@@ -73,7 +88,7 @@ WindowStack.prototype.pop = function(broadcast) {
   return this.remove(this.top(), broadcast);
 };
 
-WindowStack.prototype.remove = function(item, broadcast) {
+WindowStack.prototype.remove = function(item, broadcast, retainedId) {
   if (typeof item === 'number') {
     item = this.get(item);
   }
@@ -84,8 +99,12 @@ WindowStack.prototype.remove = function(item, broadcast) {
   this._items.splice(index, 1);
   if (wasTop) {
     var top = this.top();
-    this._show(top);
+    var retained = top && top._synced && retainedId && top._id() === retainedId;
+    this._show(top, undefined, retained);
     this._hide(item, top && top.constructor === item.constructor ? false : broadcast);
+  } else {
+    item._synced = false;
+    simply.impl.windowHide(item._id());
   }
   console.log('(-) ' + item._toString() + ' : ' + this._toString());
   return item;
@@ -101,10 +120,10 @@ WindowStack.prototype.get = function(windowId) {
   }
 };
 
-WindowStack.prototype.emitHide = function(windowId) {
+WindowStack.prototype.emitHide = function(windowId, retainedId) {
   var wind = this.get(windowId);
   if (wind !== this.top()) { return; }
-  this.remove(wind);
+  this.remove(wind, undefined, retainedId);
 };
 
 WindowStack.prototype._toString = function() {
@@ -10,28 +10,52 @@
 #include "simply_window_stack.h"
 #include "simply_wakeup.h"
 
+#include "util/memory.h"
+#include "util/time.h"
+
 #include <pebble.h>
 
+/**
+ * Shows the last window of the previous launch if instant launch is enabled, otherwise the last
+ * menu if there is one.
+ */
+static bool show_snapshot(Simply *simply) {
+  if (simply_window_stack_has_launch_snapshot() &&
+      simply_window_stack_show_launch_snapshot(simply_get_window_stack(simply))) {
+    return true;
+  }
+  SimplyMenu *menu = NULL;
+  if (simply_menu_has_snapshot()) {
+    menu = (SimplyMenu*) simply_window_stack_get_window(simply_get_window_stack(simply),
+                                                        WindowTypeMenu);
+  }
+  if (!menu || !simply_menu_show_snapshot(menu)) {
+    return false;
+  }
+  simply_get_window_stack(simply)->snapshot_menu = &menu->window;
+  return true;
+}
+
 Simply *simply_init(void) {
-  Simply *simply = malloc(sizeof(*simply));
-  simply->accel = simply_accel_create(simply);
-  simply->res = simply_res_create(simply);
+  Simply *simply = malloc0(sizeof(*simply));
+  simply->launch_time = get_time_ms();
   simply->splash = simply_splash_create(simply);
-  simply->stage = simply_stage_create(simply);
-  simply->menu = simply_menu_create(simply);
   simply->msg = simply_msg_create(simply);
-  simply->ui = simply_ui_create(simply);
-  simply->window_stack = simply_window_stack_create(simply);
 
   simply_wakeup_init(simply);
 
-  bool animated = false;
-  window_stack_push(simply->splash->window, animated);
+  if (show_snapshot(simply)) {
+    simply_splash_destroy(simply->splash);
+  } else {
+    bool animated = false;
+    window_stack_push(simply->splash->window, animated);
+  }
 
   return simply;
 }
 
 void simply_deinit(Simply *simply) {
+  simply_window_stack_save_launch_snapshot(simply->window_stack);
   simply_window_stack_destroy(simply->window_stack);
   simply_ui_destroy(simply->ui);
   simply_msg_destroy(simply->msg);
@@ -41,3 +65,33 @@ void simply_deinit(Simply *simply) {
   simply_accel_destroy(simply->accel);
   free(simply);
 }
+
+SimplyAccel *simply_get_accel(Simply *simply) {
+  if (!simply->accel) {
+    simply->accel = simply_accel_create(simply);
+  }
+  return simply->accel;
+}
+
+SimplyRes *simply_get_res(Simply *simply) {
+  if (!simply->res) {
+    simply->res = simply_res_create(simply);
+  }
+  return simply->res;
+}
+
+SimplyWindowStack *simply_get_window_stack(Simply *simply) {
+  if (!simply->window_stack) {
+    simply->window_stack = simply_window_stack_create(simply);
+  }
+  return simply->window_stack;
+}
+
+//! Logs the time from launch to the first drawn frame once.
+void simply_mark_first_frame(Simply *simply) {
+  if (simply->has_drawn) {
+    return;
+  }
+  simply->has_drawn = true;
+  LOG("First frame %lu ms after launch", (unsigned long)(get_time_ms() - simply->launch_time));
+}
@@ -4,10 +4,14 @@
 #include "basalt/src/resource_ids.auto.h"
 #endif
 
+#include <pebble.h>
+
 #define LOG(...) APP_LOG(APP_LOG_LEVEL_DEBUG, __VA_ARGS__)
 
 typedef struct Simply Simply;
 
+//! Only the splash and messaging are created at launch, the other subsystems are created by
+//! their getters the first time they are needed.
 struct Simply {
   struct SimplyAccel *accel;
   struct SimplyRes *res;
@@ -22,7 +26,15 @@ struct Simply {
     };
     struct SimplyWindow *windows[0];
   };
+  uint32_t launch_time;
+  bool has_drawn;
 };
 
 Simply *simply_init();
 void simply_deinit(Simply *);
+
+struct SimplyAccel *simply_get_accel(Simply *simply);
+struct SimplyRes *simply_get_res(Simply *simply);
+struct SimplyWindowStack *simply_get_window_stack(Simply *simply);
+
+void simply_mark_first_frame(Simply *simply);
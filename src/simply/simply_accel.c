@@ -4,8 +4,16 @@
 
 #include "simply.h"
 
+#include "util/math.h"
+#include "util/memory.h"
+
 #include <pebble.h>
 
+#define ACCEL_RING_CAPACITY 128
+
+//! Leaves room for the message headers in the outbox
+#define ACCEL_PACKET_MAX_SIZE 480
+
 typedef Packet AccelPeekPacket;
 
 typedef struct AccelConfigPacket AccelConfigPacket;
@@ -15,6 +23,12 @@ struct __attribute__((__packed__)) AccelConfigPacket {
   uint16_t num_samples;
   AccelSamplingRate rate:8;
   bool data_subscribed;
+  uint8_t features;
+  uint16_t window;
+  uint16_t hop;
+  uint8_t gestures;
+  uint8_t num_filters;
+  SimplyAccelFilterConfig filters[];
 };
 
 typedef struct AccelTapPacket AccelTapPacket;
@@ -27,11 +41,20 @@ struct __attribute__((__packed__)) AccelTapPacket {
 
 typedef struct AccelDataPacket AccelDataPacket;
 
+//! The first sample is sent whole followed by a vibration bit per sample and the x, y and z
+//! differences to the previous sample, each delta_size bytes wide.
 struct __attribute__((__packed__)) AccelDataPacket {
   Packet packet;
   bool is_peek;
   uint8_t num_samples;
-  AccelData data[];
+  uint8_t delta_size;
+  uint32_t num_dropped;
+  uint64_t timestamp;
+  uint16_t interval;
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  uint8_t buffer[];
 };
 
 static SimplyAccel *s_accel = NULL;
@@ -46,27 +69,200 @@ static bool send_accel_tap(AccelAxisType axis, int32_t direction) {
   return simply_msg_send_packet(&packet.packet);
 }
 
-static bool send_accel_data(SimplyMsg *self, AccelData *data, uint32_t num_samples, bool is_peek) {
-  size_t data_length = sizeof(AccelData) * num_samples;
-  size_t length = sizeof(AccelDataPacket) + data_length;
-  AccelDataPacket *packet = malloc(length);
+static bool send_accel_peek(SimplyAccel *self, AccelData *data) {
+  uint8_t buffer[sizeof(AccelDataPacket) + 1];
+  AccelDataPacket *packet = (AccelDataPacket*) buffer;
+  *packet = (AccelDataPacket) {
+    .packet.type = CommandAccelData,
+    .packet.length = sizeof(buffer),
+    .is_peek = true,
+    .num_samples = 1,
+    .delta_size = sizeof(int8_t),
+    .num_dropped = self->num_dropped,
+    .timestamp = data->timestamp,
+    .x = data->x,
+    .y = data->y,
+    .z = data->z,
+  };
+  packet->buffer[0] = data->did_vibrate;
+  return simply_msg_send_packet(&packet->packet);
+}
+
+static SimplyAccelSample *get_sample(SimplyAccel *self, uint16_t index) {
+  return &self->ring[(self->ring_start + index) % ACCEL_RING_CAPACITY];
+}
+
+static void pop_samples(SimplyAccel *self, uint16_t num_samples) {
+  while (num_samples-- && self->ring_count) {
+    self->ring_start = (self->ring_start + 1) % ACCEL_RING_CAPACITY;
+    if (--self->ring_count) {
+      self->ring_timestamp += get_sample(self, 0)->time_delta;
+    }
+  }
+}
+
+static void push_sample(SimplyAccel *self, AccelData *data) {
+  if (self->ring_count == ACCEL_RING_CAPACITY) {
+    pop_samples(self, 1);
+    ++self->num_dropped;
+  }
+  const uint64_t time_delta = self->ring_count ? data->timestamp - self->last_timestamp : 0;
+  if (!self->ring_count) {
+    self->ring_timestamp = data->timestamp;
+  }
+  *get_sample(self, self->ring_count++) = (SimplyAccelSample) {
+    .x = data->x,
+    .y = data->y,
+    .z = data->z,
+    .time_delta = MIN(time_delta, INT16_MAX),
+    .did_vibrate = data->did_vibrate,
+  };
+  self->last_timestamp = data->timestamp;
+}
+
+static size_t get_packet_size(uint16_t num_samples, size_t delta_size) {
+  return sizeof(AccelDataPacket) + (num_samples + 7) / 8 + (num_samples - 1) * 3 * delta_size;
+}
+
+static bool fits_int8(int32_t value) {
+  return (value >= INT8_MIN && value <= INT8_MAX);
+}
+
+static void write_delta(uint8_t *cursor, int32_t delta, size_t delta_size) {
+  if (delta_size == sizeof(int8_t)) {
+    *(int8_t*) cursor = delta;
+  } else {
+    const int16_t delta16 = delta;
+    memcpy(cursor, &delta16, sizeof(delta16));
+  }
+}
+
+/**
+ * Sends the oldest buffered samples as one delta encoded batch. Deltas are a single byte when
+ * every difference in the batch fits, which is the common case at higher sampling rates.
+ */
+static bool send_accel_batch(SimplyAccel *self) {
+  uint16_t num_samples = MIN(self->ring_count, UINT8_MAX);
+  size_t delta_size = sizeof(int8_t);
+  for (uint16_t i = 1; i < num_samples && delta_size == sizeof(int8_t); ++i) {
+    SimplyAccelSample *prev = get_sample(self, i - 1);
+    SimplyAccelSample *sample = get_sample(self, i);
+    if (!fits_int8(sample->x - prev->x) || !fits_int8(sample->y - prev->y) ||
+        !fits_int8(sample->z - prev->z)) {
+      delta_size = sizeof(int16_t);
+    }
+  }
+  while (num_samples > 1 && get_packet_size(num_samples, delta_size) > ACCEL_PACKET_MAX_SIZE) {
+    --num_samples;
+  }
+
+  const size_t length = get_packet_size(num_samples, delta_size);
+  AccelDataPacket *packet = malloc0(length);
   if (!packet) {
     return false;
   }
-  packet->packet = (Packet) {
-    .type = CommandAccelData,
-    .length = length,
+  SimplyAccelSample *first = get_sample(self, 0);
+  *packet = (AccelDataPacket) {
+    .packet.type = CommandAccelData,
+    .packet.length = length,
+    .num_samples = num_samples,
+    .delta_size = delta_size,
+    .num_dropped = self->num_dropped,
+    .timestamp = self->ring_timestamp,
+    .x = first->x,
+    .y = first->y,
+    .z = first->z,
   };
-  packet->is_peek = is_peek;
-  packet->num_samples = num_samples;
-  memcpy(packet->data, data, data_length);
-  bool result = simply_msg_send((uint8_t*) packet, length);
+
+  uint8_t *vibe_bits = packet->buffer;
+  uint8_t *cursor = vibe_bits + (num_samples + 7) / 8;
+  uint32_t duration = 0;
+  for (uint16_t i = 0; i < num_samples; ++i) {
+    SimplyAccelSample *sample = get_sample(self, i);
+    if (sample->did_vibrate) {
+      vibe_bits[i / 8] |= 1 << (i % 8);
+    }
+    if (i == 0) {
+      continue;
+    }
+    SimplyAccelSample *prev = get_sample(self, i - 1);
+    duration += sample->time_delta;
+    write_delta(cursor, sample->x - prev->x, delta_size);
+    write_delta(cursor + delta_size, sample->y - prev->y, delta_size);
+    write_delta(cursor + 2 * delta_size, sample->z - prev->z, delta_size);
+    cursor += 3 * delta_size;
+  }
+  packet->interval = num_samples > 1 ? (duration + (num_samples - 1) / 2) / (num_samples - 1) : 0;
+
+  bool result = simply_msg_send_packet(&packet->packet);
   free(packet);
+  if (result) {
+    pop_samples(self, num_samples);
+  }
   return result;
 }
 
+/**
+ * Sends the next batch once the previous message was delivered, so that samples wait in the ring
+ * rather than being lost to a busy outbox.
+ */
+static void send_pending_peek(SimplyAccel *self) {
+  AccelData data = { .x = 0 };
+  if (self->service_subscribed) {
+    accel_service_peek(&data);
+  }
+  if (send_accel_peek(self, &data)) {
+    self->is_peek_pending = false;
+  }
+}
+
+//! A pending peek is sent ahead of the buffered samples
+void simply_accel_flush(SimplyAccel *self) {
+  if (!self || !simply_msg_is_send_idle()) {
+    return;
+  }
+  if (self->is_peek_pending) {
+    send_pending_peek(self);
+  } else if (self->ring_count) {
+    send_accel_batch(self);
+  }
+}
+
 static void handle_accel_data(AccelData *data, uint32_t num_samples) {
-  send_accel_data(s_accel->simply->msg, data, num_samples, false);
+  simply_accel_gestures_push(&s_accel->gestures, data, num_samples);
+  simply_accel_features_push(&s_accel->features, data, num_samples);
+  if (!s_accel->ring) {
+    return;
+  }
+  for (uint32_t i = 0; i < num_samples; ++i) {
+    AccelData sample = data[i];
+    if (simply_accel_filter_apply(&s_accel->filter, &sample)) {
+      push_sample(s_accel, &sample);
+    }
+  }
+  simply_accel_flush(s_accel);
+}
+
+//! Gestures are recognized from batches of at most a tenth of a second to keep their latency low
+static uint32_t get_samples_per_update(SimplyAccel *self) {
+  if (!self->gestures.gestures) {
+    return self->num_samples;
+  }
+  return MIN(self->num_samples, MAX(self->rate / 10, 1));
+}
+
+static void set_service_subscribe(SimplyAccel *self, bool subscribe) {
+  if (subscribe) {
+    if (!self->service_subscribed) {
+      accel_data_service_subscribe(get_samples_per_update(self), handle_accel_data);
+    } else {
+      accel_service_set_samples_per_update(get_samples_per_update(self));
+    }
+    accel_service_set_sampling_rate(self->rate);
+  } else if (self->service_subscribed) {
+    accel_data_service_unsubscribe();
+  }
+  self->service_subscribed = subscribe;
 }
 
 static void set_data_subscribe(SimplyAccel *self, bool subscribe) {
@@ -74,10 +270,12 @@ static void set_data_subscribe(SimplyAccel *self, bool subscribe) {
     return;
   }
   if (subscribe) {
-    accel_data_service_subscribe(self->num_samples, handle_accel_data);
-    accel_service_set_sampling_rate(self->rate);
+    self->ring = malloc(ACCEL_RING_CAPACITY * sizeof(SimplyAccelSample));
+    self->ring_start = self->ring_count = 0;
+    self->num_dropped = 0;
   } else {
-    accel_data_service_unsubscribe();
+    free(self->ring);
+    self->ring = NULL;
   }
   self->data_subscribed = subscribe;
 }
@@ -86,26 +284,28 @@ static void handle_accel_tap(AccelAxisType axis, int32_t direction) {
   send_accel_tap(axis, direction);
 }
 
-static void accel_peek_timer_callback(void *context) {
-  Simply *simply = context;
-  AccelData data = { .x = 0 };
-  if (s_accel->data_subscribed) {
-    accel_service_peek(&data);
-  }
-  if (!send_accel_data(simply->msg, &data, 1, true)) {
-    app_timer_register(10, accel_peek_timer_callback, simply);
-  }
-}
-
+/**
+ * Peeks requested while one is pending share its result, the phone answers every waiting callback
+ * with the first result that arrives. The peek is sent once the outbox is idle.
+ */
 static void handle_accel_peek_packet(Simply *simply, Packet *data) {
-  app_timer_register(10, accel_peek_timer_callback, simply);
+  SimplyAccel *self = simply_get_accel(simply);
+  self->is_peek_pending = true;
+  simply_accel_flush(self);
 }
 
 static void handle_accel_config_packet(Simply *simply, Packet *data) {
   AccelConfigPacket *packet = (AccelConfigPacket*) data;
-  s_accel->num_samples = packet->num_samples;
-  s_accel->rate = packet->rate;
-  set_data_subscribe(simply->accel, packet->data_subscribed);
+  SimplyAccel *self = simply_get_accel(simply);
+  self->num_samples = packet->num_samples;
+  self->rate = packet->rate;
+  set_data_subscribe(self, packet->data_subscribed);
+  simply_accel_features_configure(&self->features, packet->features, packet->window,
+                                  packet->hop, packet->rate);
+  simply_accel_filter_configure(&self->filter, packet->filters, packet->num_filters);
+  simply_accel_gestures_configure(&self->gestures, packet->gestures, packet->rate);
+  set_service_subscribe(self, self->data_subscribed || self->features.features ||
+                        self->gestures.gestures);
 }
 
 bool simply_accel_handle_packet(Simply *simply, Packet *packet) {
@@ -145,6 +345,11 @@ void simply_accel_destroy(SimplyAccel *self) {
 
   accel_tap_service_unsubscribe();
 
+  set_service_subscribe(self, false);
+  set_data_subscribe(self, false);
+  simply_accel_features_deinit(&self->features);
+  simply_accel_filter_deinit(&self->filter);
+
   free(self);
 
   s_accel = NULL;
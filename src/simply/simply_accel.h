@@ -1,21 +1,53 @@
 #pragma once
 
+#include "simply_accel_features.h"
+#include "simply_accel_filter.h"
+#include "simply_accel_gesture.h"
 #include "simply_msg.h"
 
 #include "simply.h"
 
 #include <pebble.h>
 
+typedef struct SimplyAccelSample SimplyAccelSample;
+
+//! A buffered sample. Only the time since the previous sample is kept.
+struct SimplyAccelSample {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  uint16_t time_delta:15;
+  uint16_t did_vibrate:1;
+};
+
 typedef struct SimplyAccel SimplyAccel;
 
 struct SimplyAccel {
   Simply *simply;
+  //! Samples waiting for the outbox, oldest first
+  SimplyAccelSample *ring;
+  uint64_t ring_timestamp;
+  uint64_t last_timestamp;
+  uint16_t ring_start;
+  uint16_t ring_count;
+  //! Samples dropped because the ring was full, reported with every batch
+  uint32_t num_dropped;
+  SimplyAccelFeatures features;
+  //! Applied to the samples sent as data, features see the unfiltered samples
+  SimplyAccelFilter filter;
+  SimplyAccelGestures gestures;
   uint16_t num_samples;
   AccelSamplingRate rate:8;
   bool data_subscribed;
+  //! Pending peek shared by all peek requests until it is sent
+  bool is_peek_pending;
+  //! Whether the data service runs, either for raw data or for features
+  bool service_subscribed;
 };
 
 SimplyAccel *simply_accel_create(Simply *simply);
 void simply_accel_destroy(SimplyAccel *self);
 
+void simply_accel_flush(SimplyAccel *self);
+
 bool simply_accel_handle_packet(Simply *simply, Packet *packet);
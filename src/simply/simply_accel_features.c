@@ -0,0 +1,256 @@
+#include "simply_accel_features.h"
+
+#include "simply_msg.h"
+
+#include "util/fixed.h"
+#include "util/math.h"
+#include "util/memory.h"
+
+#include <pebble.h>
+
+#define ACCEL_FEATURES_MAX_WINDOW 128
+
+//! Magnitude above the window mean in milli-g for a local maximum to count as a peak
+#define ACCEL_PEAK_THRESHOLD 200
+
+//! Magnitude above the window mean in milli-g that starts a step
+#define ACCEL_STEP_THRESHOLD 120
+
+//! Shortest time between two steps in milliseconds
+#define ACCEL_STEP_MIN_INTERVAL 250
+
+typedef struct AccelFeaturesPacket AccelFeaturesPacket;
+
+//! The buffer holds each selected feature in the order of the feature bits.
+struct __attribute__((__packed__)) AccelFeaturesPacket {
+  Packet packet;
+  uint8_t features;
+  uint16_t num_samples;
+  uint64_t timestamp;
+  uint8_t buffer[];
+};
+
+typedef struct AccelFeaturesSums AccelFeaturesSums;
+
+struct AccelFeaturesSums {
+  int32_t x;
+  int32_t y;
+  int32_t z;
+  uint32_t magnitude;
+};
+
+static SimplyAccelPoint *get_point(SimplyAccelFeatures *self, uint16_t index) {
+  return &self->points[(self->start + index) % self->window];
+}
+
+static uint8_t *write_value(uint8_t *cursor, const void *value, size_t size) {
+  memcpy(cursor, value, size);
+  return cursor + size;
+}
+
+static uint8_t *write_uint8(uint8_t *cursor, uint32_t value) {
+  *cursor = MIN(value, UINT8_MAX);
+  return cursor + 1;
+}
+
+static uint8_t *write_magnitude(SimplyAccelFeatures *self, uint8_t *cursor, uint16_t mean) {
+  uint16_t max = 0;
+  for (uint16_t i = 0; i < self->count; ++i) {
+    max = MAX(max, get_point(self, i)->magnitude);
+  }
+  cursor = write_value(cursor, &mean, sizeof(mean));
+  return write_value(cursor, &max, sizeof(max));
+}
+
+static uint8_t *write_mean(uint8_t *cursor, SimplyAccelPoint *mean) {
+  cursor = write_value(cursor, &mean->x, sizeof(mean->x));
+  cursor = write_value(cursor, &mean->y, sizeof(mean->y));
+  return write_value(cursor, &mean->z, sizeof(mean->z));
+}
+
+static uint32_t square(int32_t value) {
+  return value * value;
+}
+
+static uint8_t *write_variance(SimplyAccelFeatures *self, uint8_t *cursor,
+                               SimplyAccelPoint *mean) {
+  uint64_t sum_x = 0, sum_y = 0, sum_z = 0;
+  for (uint16_t i = 0; i < self->count; ++i) {
+    SimplyAccelPoint *point = get_point(self, i);
+    sum_x += square(point->x - mean->x);
+    sum_y += square(point->y - mean->y);
+    sum_z += square(point->z - mean->z);
+  }
+  const uint32_t variance[3] = {
+    sum_x / self->count,
+    sum_y / self->count,
+    sum_z / self->count,
+  };
+  return write_value(cursor, variance, sizeof(variance));
+}
+
+static uint8_t *write_peaks(SimplyAccelFeatures *self, uint8_t *cursor, uint16_t mean) {
+  uint32_t num_peaks = 0;
+  for (uint16_t i = 1; i + 1 < self->count; ++i) {
+    const uint16_t magnitude = get_point(self, i)->magnitude;
+    if (magnitude > mean + ACCEL_PEAK_THRESHOLD &&
+        magnitude > get_point(self, i - 1)->magnitude &&
+        magnitude >= get_point(self, i + 1)->magnitude) {
+      ++num_peaks;
+    }
+  }
+  return write_uint8(cursor, num_peaks);
+}
+
+static uint32_t count_crossings(SimplyAccelFeatures *self, size_t offset, int16_t mean) {
+  uint32_t num_crossings = 0;
+  int sign = 0;
+  for (uint16_t i = 0; i < self->count; ++i) {
+    int16_t value;
+    memcpy(&value, (uint8_t*) get_point(self, i) + offset, sizeof(value));
+    if (value == mean) {
+      continue;
+    }
+    const int next_sign = value > mean ? 1 : -1;
+    if (sign && next_sign != sign) {
+      ++num_crossings;
+    }
+    sign = next_sign;
+  }
+  return num_crossings;
+}
+
+static uint8_t *write_zero_crossings(SimplyAccelFeatures *self, uint8_t *cursor,
+                                     SimplyAccelPoint *mean) {
+  cursor = write_uint8(cursor, count_crossings(self, offsetof(SimplyAccelPoint, x), mean->x));
+  cursor = write_uint8(cursor, count_crossings(self, offsetof(SimplyAccelPoint, y), mean->y));
+  return write_uint8(cursor, count_crossings(self, offsetof(SimplyAccelPoint, z), mean->z));
+}
+
+/**
+ * Counts rises of the magnitude above its mean. The magnitude has to fall back to the mean before
+ * the next step and steps closer than the step gap are ignored to reject the jitter of a landing.
+ */
+static uint8_t *write_steps(SimplyAccelFeatures *self, uint8_t *cursor, uint16_t mean) {
+  uint32_t num_steps = 0;
+  bool is_rising = false;
+  int32_t last_step = -(int32_t) self->step_gap;
+  for (uint16_t i = 0; i < self->count; ++i) {
+    const uint16_t magnitude = get_point(self, i)->magnitude;
+    if (!is_rising && magnitude > mean + ACCEL_STEP_THRESHOLD && i - last_step >= self->step_gap) {
+      is_rising = true;
+      last_step = i;
+      ++num_steps;
+    } else if (is_rising && magnitude <= mean) {
+      is_rising = false;
+    }
+  }
+  return write_uint8(cursor, num_steps);
+}
+
+static bool send_features(SimplyAccelFeatures *self) {
+  AccelFeaturesSums sums = {};
+  for (uint16_t i = 0; i < self->count; ++i) {
+    SimplyAccelPoint *point = get_point(self, i);
+    sums.x += point->x;
+    sums.y += point->y;
+    sums.z += point->z;
+    sums.magnitude += point->magnitude;
+  }
+  SimplyAccelPoint mean = {
+    .x = sums.x / self->count,
+    .y = sums.y / self->count,
+    .z = sums.z / self->count,
+    .magnitude = sums.magnitude / self->count,
+  };
+
+  uint8_t buffer[sizeof(AccelFeaturesPacket) + 32];
+  AccelFeaturesPacket *packet = (AccelFeaturesPacket*) buffer;
+  uint8_t *cursor = packet->buffer;
+  if (self->features & SimplyAccelFeatureMagnitude) {
+    cursor = write_magnitude(self, cursor, mean.magnitude);
+  }
+  if (self->features & SimplyAccelFeatureMean) {
+    cursor = write_mean(cursor, &mean);
+  }
+  if (self->features & SimplyAccelFeatureVariance) {
+    cursor = write_variance(self, cursor, &mean);
+  }
+  if (self->features & SimplyAccelFeaturePeaks) {
+    cursor = write_peaks(self, cursor, mean.magnitude);
+  }
+  if (self->features & SimplyAccelFeatureZeroCrossings) {
+    cursor = write_zero_crossings(self, cursor, &mean);
+  }
+  if (self->features & SimplyAccelFeatureSteps) {
+    cursor = write_steps(self, cursor, mean.magnitude);
+  }
+  packet->packet = (Packet) {
+    .type = CommandAccelFeatures,
+    .length = cursor - buffer,
+  };
+  packet->features = self->features;
+  packet->num_samples = self->count;
+  packet->timestamp = self->timestamp;
+  return simply_msg_send_packet(&packet->packet);
+}
+
+static void push_point(SimplyAccelFeatures *self, AccelData *data) {
+  const uint32_t magnitude = isqrt32(square(data->x) + square(data->y) + square(data->z));
+  SimplyAccelPoint point = {
+    .x = data->x,
+    .y = data->y,
+    .z = data->z,
+    .magnitude = MIN(magnitude, UINT16_MAX),
+  };
+  if (self->count < self->window) {
+    *get_point(self, self->count++) = point;
+  } else {
+    *get_point(self, 0) = point;
+    self->start = (self->start + 1) % self->window;
+  }
+  self->timestamp = data->timestamp;
+}
+
+void simply_accel_features_push(SimplyAccelFeatures *self, AccelData *data, uint32_t num_samples) {
+  if (!self->points) {
+    return;
+  }
+  for (uint32_t i = 0; i < num_samples; ++i) {
+    push_point(self, &data[i]);
+    ++self->num_new;
+    if (self->count == self->window && self->num_new >= self->hop) {
+      self->num_new = 0;
+      send_features(self);
+    }
+  }
+}
+
+bool simply_accel_features_configure(SimplyAccelFeatures *self, uint8_t features, uint16_t window,
+                                     uint16_t hop, uint16_t rate) {
+  window = MIN(MAX(window, 2), ACCEL_FEATURES_MAX_WINDOW);
+  hop = MIN(MAX(hop, 1), window);
+  const uint16_t step_gap = MAX(rate * ACCEL_STEP_MIN_INTERVAL / 1000, 1);
+  if (features == self->features && window == self->window && hop == self->hop &&
+      step_gap == self->step_gap) {
+    return true;
+  }
+  simply_accel_features_deinit(self);
+  if (!features) {
+    return true;
+  }
+  self->points = malloc(window * sizeof(SimplyAccelPoint));
+  if (!self->points) {
+    return false;
+  }
+  self->features = features;
+  self->window = window;
+  self->hop = hop;
+  self->step_gap = step_gap;
+  return true;
+}
+
+void simply_accel_features_deinit(SimplyAccelFeatures *self) {
+  free(self->points);
+  *self = (SimplyAccelFeatures) {};
+}
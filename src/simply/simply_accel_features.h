@@ -0,0 +1,51 @@
+#pragma once
+
+#include "simply_msg.h"
+
+#include "simply.h"
+
+#include <pebble.h>
+
+typedef enum SimplyAccelFeature SimplyAccelFeature;
+
+enum SimplyAccelFeature {
+  SimplyAccelFeatureMagnitude = 1 << 0,
+  SimplyAccelFeatureMean = 1 << 1,
+  SimplyAccelFeatureVariance = 1 << 2,
+  SimplyAccelFeaturePeaks = 1 << 3,
+  SimplyAccelFeatureZeroCrossings = 1 << 4,
+  SimplyAccelFeatureSteps = 1 << 5,
+};
+
+typedef struct SimplyAccelPoint SimplyAccelPoint;
+
+struct SimplyAccelPoint {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  uint16_t magnitude;
+};
+
+typedef struct SimplyAccelFeatures SimplyAccelFeatures;
+
+//! Summarizes a sliding window of samples on the watch so that only the features are sent.
+struct SimplyAccelFeatures {
+  //! The last window samples, oldest first starting at start
+  SimplyAccelPoint *points;
+  //! Time of the newest sample
+  uint64_t timestamp;
+  uint16_t window;
+  uint16_t hop;
+  uint16_t start;
+  uint16_t count;
+  uint16_t num_new;
+  //! Fewest samples between two steps
+  uint16_t step_gap;
+  uint8_t features;
+};
+
+bool simply_accel_features_configure(SimplyAccelFeatures *self, uint8_t features, uint16_t window,
+                                     uint16_t hop, uint16_t rate);
+void simply_accel_features_deinit(SimplyAccelFeatures *self);
+
+void simply_accel_features_push(SimplyAccelFeatures *self, AccelData *data, uint32_t num_samples);
@@ -0,0 +1,124 @@
+#include "simply_accel_filter.h"
+
+#include "util/fixed.h"
+#include "util/math.h"
+#include "util/memory.h"
+
+#include <pebble.h>
+
+//! Extra bits of precision kept by the moving average
+#define EMA_SHIFT 8
+
+//! Extra bits of precision kept for the biquad outputs
+#define BIQUAD_SHIFT 8
+
+static int32_t apply_ema(SimplyAccelFilterStage *stage, int32_t *state, int32_t value) {
+  if (!stage->counter) {
+    state[0] = value << EMA_SHIFT;
+  } else {
+    state[0] += fixed_mul_q14((value << EMA_SHIFT) - state[0], stage->config.params[0]);
+  }
+  return (state[0] + (1 << (EMA_SHIFT - 1))) >> EMA_SHIFT;
+}
+
+/**
+ * Direct form I, with the state holding x[n-1], x[n-2], y[n-1] and y[n-2]. The outputs are kept
+ * with extra precision, otherwise rounding makes low cutoff filters stall short of zero.
+ */
+static int32_t apply_biquad(SimplyAccelFilterStage *stage, int32_t *state, int32_t value) {
+  int16_t params[5];
+  memcpy(params, stage->config.params, sizeof(params));
+  if (!stage->counter) {
+    // Start from the response to a constant input to avoid a transient on the first samples
+    const int32_t dc_divisor = (1 << 14) + params[3] + params[4];
+    state[0] = state[1] = value;
+    state[2] = state[3] = dc_divisor ? saturate_int16((int64_t) value *
+        (params[0] + params[1] + params[2]) / dc_divisor) << BIQUAD_SHIFT : 0;
+  }
+  const int64_t sum = (((int64_t) params[0] * value + (int64_t) params[1] * state[0] +
+      (int64_t) params[2] * state[1]) << BIQUAD_SHIFT) - (int64_t) params[3] * state[2] -
+      (int64_t) params[4] * state[3];
+  const int32_t result = (sum + (1 << 13)) >> 14;
+  state[1] = state[0];
+  state[0] = value;
+  state[3] = state[2];
+  state[2] = result;
+  return (result + (1 << (BIQUAD_SHIFT - 1))) >> BIQUAD_SHIFT;
+}
+
+static void apply_axes(SimplyAccelFilterStage *stage, AccelData *data,
+                       int32_t (*apply)(SimplyAccelFilterStage *, int32_t *, int32_t)) {
+  data->x = saturate_int16(apply(stage, stage->state[0], data->x));
+  data->y = saturate_int16(apply(stage, stage->state[1], data->y));
+  data->z = saturate_int16(apply(stage, stage->state[2], data->z));
+  stage->counter = 1;
+}
+
+static bool apply_decimate(SimplyAccelFilterStage *stage, AccelData *data) {
+  stage->did_vibrate |= data->did_vibrate;
+  if (++stage->counter < stage->config.params[0]) {
+    return false;
+  }
+  data->did_vibrate = stage->did_vibrate;
+  stage->did_vibrate = false;
+  stage->counter = 0;
+  return true;
+}
+
+/**
+ * Runs a sample through the chain in place. Returns false when a decimation stage drops the
+ * sample, in which case it must not be sent.
+ */
+bool simply_accel_filter_apply(SimplyAccelFilter *self, AccelData *data) {
+  for (uint8_t i = 0; i < self->num_stages; ++i) {
+    SimplyAccelFilterStage *stage = &self->stages[i];
+    switch (stage->config.type) {
+      case SimplyAccelFilterNone:
+        break;
+      case SimplyAccelFilterEma:
+        apply_axes(stage, data, apply_ema);
+        break;
+      case SimplyAccelFilterBiquad:
+        apply_axes(stage, data, apply_biquad);
+        break;
+      case SimplyAccelFilterDecimate:
+        if (!apply_decimate(stage, data)) {
+          return false;
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+bool simply_accel_filter_configure(SimplyAccelFilter *self, const SimplyAccelFilterConfig *configs,
+                                   uint8_t num_configs) {
+  num_configs = MIN(num_configs, SIMPLY_ACCEL_MAX_FILTERS);
+  if (num_configs == self->num_stages) {
+    bool is_same = true;
+    for (uint8_t i = 0; i < num_configs && is_same; ++i) {
+      is_same = !memcmp(&self->stages[i].config, &configs[i], sizeof(*configs));
+    }
+    if (is_same) {
+      return true;
+    }
+  }
+  simply_accel_filter_deinit(self);
+  if (!num_configs) {
+    return true;
+  }
+  self->stages = malloc0(num_configs * sizeof(SimplyAccelFilterStage));
+  if (!self->stages) {
+    return false;
+  }
+  for (uint8_t i = 0; i < num_configs; ++i) {
+    memcpy(&self->stages[i].config, &configs[i], sizeof(*configs));
+  }
+  self->num_stages = num_configs;
+  return true;
+}
+
+void simply_accel_filter_deinit(SimplyAccelFilter *self) {
+  free(self->stages);
+  *self = (SimplyAccelFilter) {};
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <pebble.h>
+
+#define SIMPLY_ACCEL_MAX_FILTERS 4
+
+typedef enum SimplyAccelFilterType SimplyAccelFilterType;
+
+enum SimplyAccelFilterType {
+  SimplyAccelFilterNone = 0,
+  //! Exponential moving average with params[0] as the Q14 smoothing factor
+  SimplyAccelFilterEma,
+  //! Biquad with the Q14 coefficients b0, b1, b2, a1 and a2 in params, normalized by a0
+  SimplyAccelFilterBiquad,
+  //! Keeps one of every params[0] samples
+  SimplyAccelFilterDecimate,
+};
+
+typedef struct SimplyAccelFilterConfig SimplyAccelFilterConfig;
+
+struct __attribute__((__packed__)) SimplyAccelFilterConfig {
+  SimplyAccelFilterType type:8;
+  int16_t params[5];
+};
+
+typedef struct SimplyAccelFilterStage SimplyAccelFilterStage;
+
+struct SimplyAccelFilterStage {
+  SimplyAccelFilterConfig config;
+  //! Per axis history, the meaning depends on the filter type
+  int32_t state[3][4];
+  uint16_t counter;
+  bool did_vibrate;
+};
+
+typedef struct SimplyAccelFilter SimplyAccelFilter;
+
+//! A chain of integer filters applied to samples before they are sent.
+struct SimplyAccelFilter {
+  SimplyAccelFilterStage *stages;
+  uint8_t num_stages;
+};
+
+bool simply_accel_filter_configure(SimplyAccelFilter *self, const SimplyAccelFilterConfig *configs,
+                                   uint8_t num_configs);
+void simply_accel_filter_deinit(SimplyAccelFilter *self);
+
+bool simply_accel_filter_apply(SimplyAccelFilter *self, AccelData *data);
@@ -0,0 +1,177 @@
+#include "simply_accel_gesture.h"
+
+#include "simply_msg.h"
+
+#include "util/fixed.h"
+
+#include <pebble.h>
+
+//! Deviation of the magnitude from 1g in milli-g that counts as a swing of a shake
+#define SHAKE_SWING_THRESHOLD 800
+//! Deviation the magnitude has to fall below before the next swing
+#define SHAKE_REST_THRESHOLD 300
+#define SHAKE_MIN_SWINGS 3
+#define SHAKE_DURATION 800
+#define SHAKE_COOLDOWN 1000
+
+//! Acceleration across the y axis beyond gravity in milli-g that counts as a flick
+#define FLICK_THRESHOLD 700
+#define FLICK_COOLDOWN 400
+
+//! Gravity across the x or y axis in milli-g that enters and leaves a tilt, about 20 and 14 degrees
+#define TILT_ENTER_THRESHOLD 350
+#define TILT_LEAVE_THRESHOLD 250
+
+//! Largest deviation from gravity in milli-g while holding still
+#define STILL_THRESHOLD 50
+#define STILL_DURATION 1000
+
+typedef struct AccelGesturePacket AccelGesturePacket;
+
+struct __attribute__((__packed__)) AccelGesturePacket {
+  Packet packet;
+  SimplyAccelGesture gesture:8;
+  AccelAxisType axis:8;
+  int8_t direction;
+};
+
+static bool send_accel_gesture(SimplyAccelGesture gesture, AccelAxisType axis, int8_t direction) {
+  AccelGesturePacket packet = {
+    .packet.type = CommandAccelGesture,
+    .packet.length = sizeof(packet),
+    .gesture = gesture,
+    .axis = axis,
+    .direction = direction,
+  };
+  return simply_msg_send_packet(&packet.packet);
+}
+
+static bool is_enabled(SimplyAccelGestures *self, SimplyAccelGesture gesture) {
+  return (self->gestures & (1 << gesture));
+}
+
+static int32_t get_gravity(SimplyAccelGestures *self, AccelAxisType axis) {
+  return self->gravity[axis] >> self->gravity_shift;
+}
+
+static int32_t abs32(int32_t value) {
+  return value < 0 ? -value : value;
+}
+
+static void update_gravity(SimplyAccelGestures *self, AccelData *data) {
+  const int16_t values[3] = { data->x, data->y, data->z };
+  for (int i = 0; i < 3; ++i) {
+    if (!self->is_primed) {
+      self->gravity[i] = values[i] << self->gravity_shift;
+    } else {
+      self->gravity[i] += values[i] - get_gravity(self, i);
+    }
+  }
+  self->is_primed = true;
+}
+
+//! A shake is several strong swings of the magnitude in quick succession.
+static void detect_shake(SimplyAccelGestures *self, AccelData *data, uint32_t magnitude) {
+  const int32_t deviation = abs32(magnitude - 1000);
+  if (self->is_swinging) {
+    self->is_swinging = (deviation > SHAKE_REST_THRESHOLD);
+    return;
+  }
+  if (deviation <= SHAKE_SWING_THRESHOLD || data->timestamp < self->shake_until) {
+    return;
+  }
+  self->is_swinging = true;
+  if (!self->num_swings || data->timestamp - self->shake_start > SHAKE_DURATION) {
+    self->num_swings = 0;
+    self->shake_start = data->timestamp;
+  }
+  if (++self->num_swings >= SHAKE_MIN_SWINGS) {
+    self->num_swings = 0;
+    self->shake_until = data->timestamp + SHAKE_COOLDOWN;
+    self->flick_until = self->shake_until;
+    send_accel_gesture(SimplyAccelGestureShake, ACCEL_AXIS_Z, 0);
+  }
+}
+
+//! A flick is a sharp turn of the wrist, which accelerates the watch across its y axis.
+static void detect_flick(SimplyAccelGestures *self, AccelData *data) {
+  const int32_t motion = data->y - get_gravity(self, ACCEL_AXIS_Y);
+  if (abs32(motion) <= FLICK_THRESHOLD || data->timestamp < self->flick_until) {
+    return;
+  }
+  self->flick_until = data->timestamp + FLICK_COOLDOWN;
+  send_accel_gesture(SimplyAccelGestureFlick, ACCEL_AXIS_Y, motion > 0 ? 1 : -1);
+}
+
+//! Reports entering and leaving a tilt along the x and y axes, leaving has a direction of 0.
+static void detect_tilt(SimplyAccelGestures *self) {
+  for (AccelAxisType axis = ACCEL_AXIS_X; axis <= ACCEL_AXIS_Y; ++axis) {
+    const int32_t gravity = get_gravity(self, axis);
+    int8_t tilt = self->tilt[axis];
+    if (abs32(gravity) > TILT_ENTER_THRESHOLD) {
+      tilt = gravity > 0 ? 1 : -1;
+    } else if (abs32(gravity) < TILT_LEAVE_THRESHOLD) {
+      tilt = 0;
+    }
+    if (tilt != self->tilt[axis]) {
+      self->tilt[axis] = tilt;
+      send_accel_gesture(SimplyAccelGestureTilt, axis, tilt);
+    }
+  }
+}
+
+//! Reports once when the watch has been held still for a while.
+static void detect_still(SimplyAccelGestures *self, AccelData *data) {
+  const bool is_moving =
+      abs32(data->x - get_gravity(self, ACCEL_AXIS_X)) > STILL_THRESHOLD ||
+      abs32(data->y - get_gravity(self, ACCEL_AXIS_Y)) > STILL_THRESHOLD ||
+      abs32(data->z - get_gravity(self, ACCEL_AXIS_Z)) > STILL_THRESHOLD;
+  if (is_moving || !self->still_since) {
+    self->still_since = data->timestamp;
+    self->is_still = false;
+  } else if (!self->is_still && data->timestamp - self->still_since >= STILL_DURATION) {
+    self->is_still = true;
+    send_accel_gesture(SimplyAccelGestureStill, ACCEL_AXIS_Z, 0);
+  }
+}
+
+void simply_accel_gestures_push(SimplyAccelGestures *self, AccelData *data, uint32_t num_samples) {
+  if (!self->gestures) {
+    return;
+  }
+  for (uint32_t i = 0; i < num_samples; ++i) {
+    AccelData *sample = &data[i];
+    if (sample->did_vibrate) {
+      continue;
+    }
+    update_gravity(self, sample);
+    if (is_enabled(self, SimplyAccelGestureShake)) {
+      const int32_t x = sample->x, y = sample->y, z = sample->z;
+      detect_shake(self, sample, isqrt32(x * x + y * y + z * z));
+    }
+    if (is_enabled(self, SimplyAccelGestureFlick)) {
+      detect_flick(self, sample);
+    }
+    if (is_enabled(self, SimplyAccelGestureTilt)) {
+      detect_tilt(self);
+    }
+    if (is_enabled(self, SimplyAccelGestureStill)) {
+      detect_still(self, sample);
+    }
+  }
+}
+
+/**
+ * Gravity is tracked with a moving average of about 150ms at every sampling rate, slow enough to
+ * ignore a flick yet quick enough for tilting to feel immediate.
+ */
+void simply_accel_gestures_configure(SimplyAccelGestures *self, uint8_t gestures, uint16_t rate) {
+  const uint8_t gravity_shift = rate >= 100 ? 4 : rate >= 50 ? 3 : rate >= 25 ? 2 : 1;
+  if (gestures == self->gestures && gravity_shift == self->gravity_shift) {
+    return;
+  }
+  *self = (SimplyAccelGestures) {
+    .gestures = gestures,
+    .gravity_shift = gravity_shift,
+  };
+}
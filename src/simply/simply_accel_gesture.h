@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pebble.h>
+
+typedef enum SimplyAccelGesture SimplyAccelGesture;
+
+enum SimplyAccelGesture {
+  SimplyAccelGestureShake = 0,
+  SimplyAccelGestureFlick,
+  SimplyAccelGestureTilt,
+  SimplyAccelGestureStill,
+};
+
+typedef struct SimplyAccelGestures SimplyAccelGestures;
+
+//! Detects wrist gestures in the sample stream with thresholds and small state machines.
+struct SimplyAccelGestures {
+  //! Low passed acceleration, with extra precision, that approximates gravity
+  int32_t gravity[3];
+  uint64_t shake_start;
+  uint64_t shake_until;
+  uint64_t flick_until;
+  uint64_t still_since;
+  //! Enabled gestures, one bit per SimplyAccelGesture
+  uint8_t gestures;
+  uint8_t gravity_shift;
+  uint8_t num_swings;
+  int8_t tilt[2];
+  bool is_primed:1;
+  bool is_swinging:1;
+  bool is_still:1;
+};
+
+void simply_accel_gestures_configure(SimplyAccelGestures *self, uint8_t gestures, uint16_t rate);
+
+void simply_accel_gestures_push(SimplyAccelGestures *self, AccelData *data, uint32_t num_samples);
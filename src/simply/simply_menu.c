@@ -8,8 +8,13 @@
 
 #include "util/color.h"
 #include "util/graphics.h"
+#include "util/hash.h"
+#include "util/math.h"
+#include "util/memory.h"
 #include "util/menu_layer.h"
-#include "util/string.h"
+#include "util/persist.h"
+#include "util/string_arena.h"
+#include "util/time.h"
 
 #include <pebble.h>
 
@@ -17,8 +22,27 @@
 
 #define MAX_CACHED_ITEMS 6
 
+#define TEXT_ARENA_SIZE 1024
+
+//! Logs the text arena peak whenever a menu hides, for tuning TEXT_ARENA_SIZE
+#ifndef SIMPLY_MENU_LOG_ARENA
+#define SIMPLY_MENU_LOG_ARENA 0
+#endif
+
 #define REQUEST_DELAY_MS 10
 
+#define REQUEST_TIMEOUT_MS 1000
+
+#define REQUEST_MAX_RETRIES 2
+
+#define SNAPSHOT_PERSIST_KEY 1000
+
+#define SNAPSHOT_VERSION 1
+
+#define SNAPSHOT_MAX_SIZE 768
+
+#define SNAPSHOT_MAX_SECTIONS 32
+
 typedef Packet MenuClearPacket;
 
 typedef struct MenuClearSectionPacket MenuClearSectionPacket;
@@ -61,6 +85,90 @@ struct __attribute__((__packed__)) MenuItemPacket {
   char buffer[];
 };
 
+typedef struct MenuItemsPacket MenuItemsPacket;
+
+struct __attribute__((__packed__)) MenuItemsPacket {
+  Packet packet;
+  uint16_t section;
+  uint16_t num_items;
+  uint8_t buffer[];
+};
+
+typedef struct MenuItemsEntry MenuItemsEntry;
+
+struct __attribute__((__packed__)) MenuItemsEntry {
+  uint16_t item;
+  uint32_t icon;
+  uint16_t title_length;
+  uint16_t subtitle_length;
+  char buffer[];
+};
+
+typedef struct MenuGetItemsPacket MenuGetItemsPacket;
+
+struct __attribute__((__packed__)) MenuGetItemsPacket {
+  Packet packet;
+  uint16_t section;
+  uint16_t item;
+  uint16_t num_items;
+};
+
+typedef struct MenuDataPacket MenuDataPacket;
+
+struct __attribute__((__packed__)) MenuDataPacket {
+  Packet packet;
+  uint16_t version;
+  uint16_t num_sections;
+  uint16_t num_items;
+  uint8_t buffer[];
+};
+
+typedef struct MenuDataAckPacket MenuDataAckPacket;
+
+struct __attribute__((__packed__)) MenuDataAckPacket {
+  Packet packet;
+  uint16_t version;
+};
+
+typedef struct MenuDataSection MenuDataSection;
+
+struct __attribute__((__packed__)) MenuDataSection {
+  uint16_t first_item;
+  uint16_t num_items;
+  uint16_t title;
+};
+
+typedef struct MenuDataItem MenuDataItem;
+
+struct __attribute__((__packed__)) MenuDataItem {
+  uint32_t icon;
+  uint16_t title;
+  uint16_t subtitle;
+};
+
+typedef struct MenuSnapshot MenuSnapshot;
+
+struct __attribute__((__packed__)) MenuSnapshot {
+  uint16_t version;
+  uint16_t length;
+  uint32_t window_id;
+  uint32_t hash;
+  uint16_t num_sections;
+  uint16_t selected_section;
+  uint16_t selected_row;
+  uint16_t num_infos;
+  uint16_t num_items;
+  uint16_t title_length;
+  uint8_t buffer[];
+};
+
+typedef struct MenuSnapshotSectionInfo MenuSnapshotSectionInfo;
+
+struct __attribute__((__packed__)) MenuSnapshotSectionInfo {
+  uint16_t num_items;
+  bool has_title;
+};
+
 typedef struct MenuItemEventPacket MenuItemEventPacket;
 
 struct __attribute__((__packed__)) MenuItemEventPacket {
@@ -92,6 +200,8 @@ static void simply_menu_clear(SimplyMenu *self);
 static void simply_menu_set_num_sections(SimplyMenu *self, uint16_t num_sections);
 static void simply_menu_add_section(SimplyMenu *self, SimplyMenuSection *section);
 static void simply_menu_add_item(SimplyMenu *self, SimplyMenuItem *item);
+static void simply_menu_add_items(SimplyMenu *self, uint16_t section, uint16_t num_items, uint8_t *buffer,
+                                  size_t length);
 
 static MenuIndex simply_menu_get_selection(SimplyMenu *self);
 static void simply_menu_set_selection(SimplyMenu *self, MenuIndex menu_index, MenuRowAlign align, bool animated);
@@ -108,6 +218,15 @@ static bool send_menu_item(Command type, uint16_t section, uint16_t item) {
   return simply_msg_send_packet(&packet.packet);
 }
 
+static bool send_menu_data_ack(uint16_t version) {
+  MenuDataAckPacket packet = {
+    .packet.type = CommandMenuDataAck,
+    .packet.length = sizeof(packet),
+    .version = version,
+  };
+  return simply_msg_send_packet(&packet.packet);
+}
+
 static bool send_menu_get_section(uint16_t index) {
   return send_menu_item(CommandMenuGetSection, index, 0);
 }
@@ -116,6 +235,17 @@ static bool send_menu_get_item(uint16_t section, uint16_t index) {
   return send_menu_item(CommandMenuGetItem, section, index);
 }
 
+static bool send_menu_get_items(uint16_t section, uint16_t index, uint16_t num_items) {
+  MenuGetItemsPacket packet = {
+    .packet.type = CommandMenuGetItems,
+    .packet.length = sizeof(packet),
+    .section = section,
+    .item = index,
+    .num_items = num_items,
+  };
+  return simply_msg_send_packet(&packet.packet);
+}
+
 static bool send_menu_select_click(uint16_t section, uint16_t index) {
   return send_menu_item(CommandMenuSelect, section, index);
 }
@@ -145,10 +275,7 @@ static SimplyMenuSection *get_menu_section(SimplyMenu *self, int index) {
 static void destroy_section(SimplyMenu *self, SimplyMenuSection *section) {
   if (!section) { return; }
   list1_remove(&self->menu_layer.sections, &section->node);
-  if (section->title && section->title != EMPTY_TITLE) {
-    free(section->title);
-    section->title = NULL;
-  }
+  string_arena_free(&self->menu_layer.text_arena, &section->title);
   free(section);
 }
 
@@ -165,15 +292,9 @@ static SimplyMenuItem *get_menu_item(SimplyMenu *self, int section, int index) {
 static void destroy_item(SimplyMenu *self, SimplyMenuItem *item) {
   if (!item) { return; }
   list1_remove(&self->menu_layer.items, &item->node);
-  if (item->title) {
-    free(item->title);
-    item->title = NULL;
-  }
-  if (item->subtitle) {
-    free(item->subtitle);
-    item->subtitle = NULL;
-  }
-  free(item);
+  string_arena_free(&self->menu_layer.text_arena, &item->title);
+  string_arena_free(&self->menu_layer.text_arena, &item->subtitle);
+  list1_prepend(&self->menu_layer.free_items, &item->node);
 }
 
 static void destroy_item_by_index(SimplyMenu *self, int section, int index) {
@@ -182,6 +303,40 @@ static void destroy_item_by_index(SimplyMenu *self, int section, int index) {
         self->menu_layer.items, item_filter, (void*)(uintptr_t) cell_index));
 }
 
+static SimplyMenuItem *alloc_item(SimplyMenu *self) {
+  if (!self->menu_layer.free_items) {
+    destroy_item(self, (SimplyMenuItem*) list1_last(self->menu_layer.items));
+  }
+  SimplyMenuItem *item = (SimplyMenuItem*) self->menu_layer.free_items;
+  if (!item) {
+    return NULL;
+  }
+  list1_remove(&self->menu_layer.free_items, &item->node);
+  *item = (SimplyMenuItem) { .title = NULL };
+  return item;
+}
+
+static bool evict_for_text(SimplyMenu *self) {
+  if (self->menu_layer.items) {
+    destroy_item(self, (SimplyMenuItem*) list1_last(self->menu_layer.items));
+    return true;
+  }
+  if (self->menu_layer.sections) {
+    destroy_section(self, (SimplyMenuSection*) list1_last(self->menu_layer.sections));
+    return true;
+  }
+  return false;
+}
+
+static void set_text(SimplyMenu *self, char **text_field, const char *str) {
+  // Make room by evicting the least recently drawn rows and headers
+  while (!string_arena_strset(&self->menu_layer.text_arena, text_field, str)) {
+    if (!evict_for_text(self)) {
+      return;
+    }
+  }
+}
+
 static void add_section(SimplyMenu *self, SimplyMenuSection *section) {
   if (list1_size(self->menu_layer.sections) >= MAX_CACHED_SECTIONS) {
     destroy_section(self, (SimplyMenuSection*) list1_last(self->menu_layer.sections));
@@ -198,31 +353,179 @@ static void add_item(SimplyMenu *self, SimplyMenuItem *item) {
   list1_prepend(&self->menu_layer.items, &item->node);
 }
 
-static void request_menu_section(SimplyMenu *self, uint16_t section_index) {
-  SimplyMenuSection *section = get_menu_section(self, section_index);
-  if (section) {
+static bool request_filter(List1Node *node, void *data) {
+  SimplyMenuRequest *request = (SimplyMenuRequest*) node;
+  SimplyMenuRequest *other = data;
+  return (request->type == other->type &&
+          request->section == other->section &&
+          request->item == other->item);
+}
+
+static bool unsent_item_request_filter(List1Node *node, void *data) {
+  SimplyMenuRequest *request = (SimplyMenuRequest*) node;
+  return (request->type == SimplyMenuTypeItem && !request->is_sent);
+}
+
+static void destroy_request(SimplyMenu *self, SimplyMenuRequest *request) {
+  if (!request) { return; }
+  list1_remove(&self->menu_layer.requests, &request->node);
+  free(request);
+}
+
+static void resolve_request(SimplyMenu *self, SimplyMenuType type, uint16_t section, uint16_t item) {
+  SimplyMenuRequest key = { .type = type, .section = section, .item = item };
+  destroy_request(self, (SimplyMenuRequest*) list1_find(self->menu_layer.requests, request_filter, &key));
+}
+
+static void clear_requests(SimplyMenu *self) {
+  while (self->menu_layer.requests) {
+    destroy_request(self, (SimplyMenuRequest*) self->menu_layer.requests);
+  }
+  if (self->menu_layer.request_timer) {
+    app_timer_cancel(self->menu_layer.request_timer);
+    self->menu_layer.request_timer = NULL;
+  }
+}
+
+static bool is_coalescable_request(SimplyMenuRequest *request, uint16_t section,
+                                   uint16_t min_item, uint16_t max_item) {
+  return (request->type == SimplyMenuTypeItem && !request->is_sent &&
+          request->section == section &&
+          request->item + 1 >= min_item && request->item <= max_item + 1);
+}
+
+static void send_item_requests(SimplyMenu *self, uint32_t now) {
+  SimplyMenuRequest *request;
+  while ((request = (SimplyMenuRequest*) list1_find(
+          self->menu_layer.requests, unsent_item_request_filter, NULL))) {
+    // Coalesce unsent requests of a section into a range of consecutive rows, growing it until no
+    // more join, so that the range never asks again for rows that are already cached
+    const uint16_t section = request->section;
+    uint16_t min_item = request->item;
+    uint16_t max_item = request->item;
+    request->is_sent = true;
+    request->sent_time = now;
+    bool merged;
+    do {
+      merged = false;
+      for (List1Node *walk = self->menu_layer.requests; walk; walk = walk->next) {
+        SimplyMenuRequest *other = (SimplyMenuRequest*) walk;
+        if (is_coalescable_request(other, section, min_item, max_item)) {
+          min_item = MIN(min_item, other->item);
+          max_item = MAX(max_item, other->item);
+          other->is_sent = true;
+          other->sent_time = now;
+          merged = true;
+        }
+      }
+    } while (merged);
+    if (min_item == max_item) {
+      send_menu_get_item(section, min_item);
+    } else {
+      send_menu_get_items(section, min_item, max_item - min_item + 1);
+    }
+  }
+}
+
+static void request_timer_callback(void *data) {
+  SimplyMenu *self = data;
+  self->menu_layer.request_timer = NULL;
+
+  const uint32_t now = get_time_ms();
+  for (List1Node *walk = self->menu_layer.requests; walk;) {
+    SimplyMenuRequest *request = (SimplyMenuRequest*) walk;
+    walk = walk->next;
+    if (!request->is_sent || now - request->sent_time < REQUEST_TIMEOUT_MS) {
+      continue;
+    }
+    if (request->num_retries >= REQUEST_MAX_RETRIES) {
+      destroy_request(self, request);
+      continue;
+    }
+    ++request->num_retries;
+    request->is_sent = false;
+  }
+
+  for (List1Node *walk = self->menu_layer.requests; walk; walk = walk->next) {
+    SimplyMenuRequest *request = (SimplyMenuRequest*) walk;
+    if (request->type == SimplyMenuTypeSection && !request->is_sent) {
+      send_menu_get_section(request->section);
+      request->is_sent = true;
+      request->sent_time = now;
+    }
+  }
+
+  send_item_requests(self, now);
+
+  if (self->menu_layer.requests) {
+    self->menu_layer.request_timer = app_timer_register(REQUEST_TIMEOUT_MS, request_timer_callback, self);
+  }
+}
+
+static void add_request(SimplyMenu *self, SimplyMenuType type, uint16_t section, uint16_t item) {
+  SimplyMenuRequest key = { .type = type, .section = section, .item = item };
+  if (list1_find(self->menu_layer.requests, request_filter, &key)) {
     return;
   }
-  section = malloc(sizeof(*section));
-  *section = (SimplyMenuSection) {
-    .section = section_index,
-  };
-  add_section(self, section);
-  send_menu_get_section(section_index);
+  SimplyMenuRequest *request = malloc(sizeof(*request));
+  if (!request) {
+    return;
+  }
+  *request = key;
+  list1_append(&self->menu_layer.requests, &request->node);
+
+  // Requests are sent after the current render pass finishes
+  if (self->menu_layer.request_timer) {
+    app_timer_reschedule(self->menu_layer.request_timer, REQUEST_DELAY_MS);
+  } else {
+    self->menu_layer.request_timer = app_timer_register(REQUEST_DELAY_MS, request_timer_callback, self);
+  }
+}
+
+static void request_menu_section(SimplyMenu *self, uint16_t section_index) {
+  add_request(self, SimplyMenuTypeSection, section_index, 0);
 }
 
 static void request_menu_item(SimplyMenu *self, uint16_t section_index, uint16_t item_index) {
-  SimplyMenuItem *item = get_menu_item(self, section_index, item_index);
-  if (item) {
-    return;
+  add_request(self, SimplyMenuTypeItem, section_index, item_index);
+}
+
+static MenuDataSection *get_data_section(SimplyMenuData *data, uint16_t section_index) {
+  if (!data || section_index >= data->num_sections) {
+    return NULL;
   }
-  item = malloc(sizeof(*item));
-  *item = (SimplyMenuItem) {
-    .section = section_index,
-    .item = item_index,
-  };
-  add_item(self, item);
-  send_menu_get_item(section_index, item_index);
+  return &((MenuDataSection*) data->buffer)[section_index];
+}
+
+static MenuDataItem *get_data_item(SimplyMenuData *data, uint16_t section_index, uint16_t item_index) {
+  MenuDataSection *section = get_data_section(data, section_index);
+  if (!section || item_index >= section->num_items) {
+    return NULL;
+  }
+  MenuDataItem *items = (MenuDataItem*) (data->buffer + data->num_sections * sizeof(MenuDataSection));
+  return &items[section->first_item + item_index];
+}
+
+static const char *get_data_string(SimplyMenuData *data, uint16_t offset) {
+  if (offset >= data->strings_length) {
+    return NULL;
+  }
+  return (const char*) data->buffer + data->num_sections * sizeof(MenuDataSection) +
+      data->num_items * sizeof(MenuDataItem) + offset;
+}
+
+static bool is_data_valid(SimplyMenuData *data) {
+  if (data->strings_length && data->buffer[data->num_sections * sizeof(MenuDataSection) +
+      data->num_items * sizeof(MenuDataItem) + data->strings_length - 1] != '\0') {
+    return false;
+  }
+  for (uint16_t i = 0; i < data->num_sections; ++i) {
+    MenuDataSection *section = get_data_section(data, i);
+    if ((uint32_t) section->first_item + section->num_items > data->num_items) {
+      return false;
+    }
+  }
+  return true;
 }
 
 static void mark_dirty(SimplyMenu *self) {
@@ -230,11 +533,78 @@ static void mark_dirty(SimplyMenu *self) {
   menu_layer_reload_data(self->menu_layer.menu_layer);
 }
 
+static SimplyMenuSectionInfo *get_section_info(SimplyMenu *self, uint16_t section_index) {
+  if (!self->menu_layer.section_infos || section_index >= self->menu_layer.num_sections) {
+    return NULL;
+  }
+  return &self->menu_layer.section_infos[section_index];
+}
+
+static void reset_section_infos(SimplyMenu *self, uint16_t start) {
+  if (!self->menu_layer.section_infos || start >= self->menu_layer.num_sections) {
+    return;
+  }
+  memset(&self->menu_layer.section_infos[start], 0,
+         (self->menu_layer.num_sections - start) * sizeof(SimplyMenuSectionInfo));
+}
+
 void simply_menu_set_num_sections(SimplyMenu *self, uint16_t num_sections) {
   if (num_sections == 0) {
     num_sections = 1;
   }
+  SimplyMenuSectionInfo *section_infos =
+      realloc(self->menu_layer.section_infos, num_sections * sizeof(SimplyMenuSectionInfo));
+  if (!section_infos) {
+    return;
+  }
+  const uint16_t old_num_sections = self->menu_layer.section_infos ? self->menu_layer.num_sections : 0;
+  self->menu_layer.section_infos = section_infos;
   self->menu_layer.num_sections = num_sections;
+  reset_section_infos(self, old_num_sections);
+  mark_dirty(self);
+}
+
+void simply_menu_set_data(SimplyMenu *self, uint16_t num_sections, uint16_t num_items,
+                          const uint8_t *buffer, size_t length) {
+  simply_menu_clear(self);
+
+  const size_t tables_size = num_sections * sizeof(MenuDataSection) + num_items * sizeof(MenuDataItem);
+  if (length < tables_size || length - tables_size > UINT16_MAX) {
+    return;
+  }
+
+  SimplyMenuData *data = malloc(sizeof(*data) + length);
+  if (!data) {
+    return;
+  }
+  *data = (SimplyMenuData) {
+    .num_sections = num_sections,
+    .num_items = num_items,
+    .strings_length = length - tables_size,
+  };
+  memcpy(data->buffer, buffer, length);
+  if (!is_data_valid(data)) {
+    free(data);
+    return;
+  }
+
+  self->menu_layer.data = data;
+  simply_menu_set_num_sections(self, num_sections);
+
+  for (uint16_t i = 0; i < num_sections; ++i) {
+    SimplyMenuSectionInfo *info = get_section_info(self, i);
+    if (!info) {
+      break;
+    }
+    MenuDataSection *section = get_data_section(data, i);
+    const char *title = get_data_string(data, section->title);
+    *info = (SimplyMenuSectionInfo) {
+      .num_items = section->num_items,
+      .is_loaded = true,
+      .has_title = (title && title[0]),
+    };
+  }
+
   mark_dirty(self);
 }
 
@@ -242,15 +612,54 @@ void simply_menu_add_section(SimplyMenu *self, SimplyMenuSection *section) {
   if (section->title == NULL) {
     section->title = EMPTY_TITLE;
   }
+  SimplyMenuSectionInfo *info = get_section_info(self, section->section);
+  if (info) {
+    *info = (SimplyMenuSectionInfo) {
+      .num_items = section->num_items,
+      .is_loaded = true,
+      .has_title = (section->title != EMPTY_TITLE),
+    };
+  }
+  resolve_request(self, SimplyMenuTypeSection, section->section, 0);
   add_section(self, section);
   mark_dirty(self);
 }
 
-void simply_menu_add_item(SimplyMenu *self, SimplyMenuItem *item) {
+static void insert_item(SimplyMenu *self, SimplyMenuItem *item) {
   if (item->title == NULL) {
     item->title = EMPTY_TITLE;
   }
+  resolve_request(self, SimplyMenuTypeItem, item->section, item->item);
   add_item(self, item);
+}
+
+void simply_menu_add_item(SimplyMenu *self, SimplyMenuItem *item) {
+  insert_item(self, item);
+  mark_dirty(self);
+}
+
+void simply_menu_add_items(SimplyMenu *self, uint16_t section, uint16_t num_items, uint8_t *buffer,
+                           size_t length) {
+  uint8_t *cursor = buffer;
+  uint8_t *end = buffer + length;
+  for (uint16_t i = 0; i < num_items && cursor + sizeof(MenuItemsEntry) <= end; ++i) {
+    MenuItemsEntry *entry = (MenuItemsEntry*) cursor;
+    cursor += sizeof(*entry) + entry->title_length + 1 + entry->subtitle_length + 1;
+    if (cursor > end) {
+      break;
+    }
+    SimplyMenuItem *item = alloc_item(self);
+    if (!item) {
+      break;
+    }
+    item->section = section;
+    item->item = entry->item;
+    item->icon = entry->icon;
+    set_text(self, &item->title, entry->title_length ? entry->buffer : NULL);
+    set_text(self, &item->subtitle,
+             entry->subtitle_length ? entry->buffer + entry->title_length + 1 : NULL);
+    insert_item(self, item);
+  }
   mark_dirty(self);
 }
 
@@ -262,6 +671,327 @@ void simply_menu_set_selection(SimplyMenu *self, MenuIndex menu_index, MenuRowAl
   menu_layer_set_selected_index(self->menu_layer.menu_layer, menu_index, align, animated);
 }
 
+static const char *get_section_title(SimplyMenu *self, uint16_t section_index) {
+  MenuDataSection *data_section = get_data_section(self->menu_layer.data, section_index);
+  if (data_section) {
+    return get_data_string(self->menu_layer.data, data_section->title);
+  }
+  SimplyMenuSection *section = get_menu_section(self, section_index);
+  return section && section->title != EMPTY_TITLE ? section->title : NULL;
+}
+
+static bool get_row(SimplyMenu *self, uint16_t section_index, uint16_t row, const char **title,
+                    const char **subtitle, uint32_t *icon) {
+  MenuDataItem *data_item = get_data_item(self->menu_layer.data, section_index, row);
+  if (data_item) {
+    *title = get_data_string(self->menu_layer.data, data_item->title);
+    *subtitle = get_data_string(self->menu_layer.data, data_item->subtitle);
+    *icon = data_item->icon;
+    return true;
+  }
+  SimplyMenuItem *item = get_menu_item(self, section_index, row);
+  if (!item) {
+    return false;
+  }
+  *title = item->title != EMPTY_TITLE ? item->title : NULL;
+  *subtitle = item->subtitle;
+  *icon = item->icon;
+  return true;
+}
+
+static size_t write_snapshot(SimplyMenu *self, MenuSnapshot *snapshot, size_t capacity) {
+  const MenuIndex selection = simply_menu_get_selection(self);
+  SimplyMenuSectionInfo *selected_info = get_section_info(self, selection.section);
+  // A snapshot only holds the infos of its first sections, which must include the selected one
+  if (!selected_info || !selected_info->is_loaded || selection.section >= SNAPSHOT_MAX_SECTIONS) {
+    return 0;
+  }
+
+  *snapshot = (MenuSnapshot) {
+    .version = SNAPSHOT_VERSION,
+    .window_id = self->window.id,
+    .num_sections = self->menu_layer.num_sections,
+    .selected_section = selection.section,
+    .selected_row = selection.row,
+    .num_infos = MIN(self->menu_layer.num_sections, SNAPSHOT_MAX_SECTIONS),
+  };
+
+  uint8_t *cursor = snapshot->buffer;
+  uint8_t *end = (uint8_t*) snapshot + capacity;
+
+  const char *section_title = get_section_title(self, selection.section);
+  snapshot->title_length = section_title ? strlen(section_title) : 0;
+  if (cursor + snapshot->num_infos * sizeof(MenuSnapshotSectionInfo) +
+      snapshot->title_length + 1 > end) {
+    return 0;
+  }
+
+  for (uint16_t i = 0; i < snapshot->num_infos; ++i) {
+    SimplyMenuSectionInfo *info = get_section_info(self, i);
+    MenuSnapshotSectionInfo *snapshot_info = (MenuSnapshotSectionInfo*) cursor;
+    *snapshot_info = (MenuSnapshotSectionInfo) {
+      .num_items = info->is_loaded ? info->num_items : 1,
+      .has_title = info->has_title,
+    };
+    cursor += sizeof(*snapshot_info);
+  }
+
+  memcpy(cursor, section_title ? section_title : "", snapshot->title_length + 1);
+  cursor += snapshot->title_length + 1;
+
+  const uint16_t first_row = MAX(0, selection.row - MAX_CACHED_ITEMS / 2);
+  for (uint16_t row = first_row; row < first_row + MAX_CACHED_ITEMS && row < selected_info->num_items;
+       ++row) {
+    const char *title = NULL;
+    const char *subtitle = NULL;
+    uint32_t icon = 0;
+    if (!get_row(self, selection.section, row, &title, &subtitle, &icon)) {
+      continue;
+    }
+    const size_t title_length = title ? strlen(title) : 0;
+    const size_t subtitle_length = subtitle ? strlen(subtitle) : 0;
+    MenuItemsEntry *entry = (MenuItemsEntry*) cursor;
+    if (cursor + sizeof(*entry) + title_length + 1 + subtitle_length + 1 > end) {
+      break;
+    }
+    *entry = (MenuItemsEntry) {
+      .item = row,
+      .icon = icon,
+      .title_length = title_length,
+      .subtitle_length = subtitle_length,
+    };
+    memcpy(entry->buffer, title ? title : "", title_length + 1);
+    memcpy(entry->buffer + title_length + 1, subtitle ? subtitle : "", subtitle_length + 1);
+    cursor += sizeof(*entry) + title_length + 1 + subtitle_length + 1;
+    snapshot->num_items++;
+  }
+
+  snapshot->length = cursor - (uint8_t*) snapshot;
+  snapshot->hash = hash_fnv1a(&snapshot->num_sections,
+                              snapshot->length - offsetof(MenuSnapshot, num_sections));
+  return snapshot->length;
+}
+
+static void save_snapshot(SimplyMenu *self) {
+  MenuSnapshot *snapshot = malloc(SNAPSHOT_MAX_SIZE);
+  if (!snapshot) {
+    return;
+  }
+  const size_t length = write_snapshot(self, snapshot, SNAPSHOT_MAX_SIZE);
+  if (length && (snapshot->hash != self->snapshot_hash ||
+                 snapshot->window_id != self->snapshot_saved_window_id)) {
+    if (persist_write_chunked(SNAPSHOT_PERSIST_KEY, snapshot, length)) {
+      self->snapshot_hash = snapshot->hash;
+      self->snapshot_saved_window_id = snapshot->window_id;
+    }
+  }
+  free(snapshot);
+}
+
+static bool is_snapshot_valid(MenuSnapshot *snapshot, size_t length) {
+  if (length < sizeof(*snapshot) || snapshot->version != SNAPSHOT_VERSION ||
+      snapshot->length < sizeof(*snapshot) || snapshot->length > length) {
+    return false;
+  }
+  const size_t header_size = snapshot->num_infos * sizeof(MenuSnapshotSectionInfo) +
+      snapshot->title_length + 1;
+  if (sizeof(*snapshot) + header_size > snapshot->length ||
+      snapshot->num_infos > snapshot->num_sections ||
+      snapshot->selected_section >= snapshot->num_infos) {
+    return false;
+  }
+  return (snapshot->hash == hash_fnv1a(&snapshot->num_sections,
+                                       snapshot->length - offsetof(MenuSnapshot, num_sections)));
+}
+
+static MenuIndex load_snapshot(SimplyMenu *self, MenuSnapshot *snapshot) {
+  simply_menu_set_num_sections(self, snapshot->num_sections);
+
+  uint8_t *cursor = snapshot->buffer;
+  for (uint16_t i = 0; i < snapshot->num_infos; ++i) {
+    MenuSnapshotSectionInfo *snapshot_info = (MenuSnapshotSectionInfo*) cursor;
+    SimplyMenuSectionInfo *info = get_section_info(self, i);
+    if (info) {
+      *info = (SimplyMenuSectionInfo) {
+        .num_items = snapshot_info->num_items,
+        .is_loaded = true,
+        .has_title = snapshot_info->has_title,
+      };
+    }
+    cursor += sizeof(*snapshot_info);
+  }
+
+  const char *title = (const char*) cursor;
+  cursor += snapshot->title_length + 1;
+
+  SimplyMenuSection *section = malloc0(sizeof(*section));
+  if (section) {
+    section->section = snapshot->selected_section;
+    section->num_items = ((MenuSnapshotSectionInfo*) snapshot->buffer)[section->section].num_items;
+    set_text(self, &section->title, title);
+    simply_menu_add_section(self, section);
+  }
+
+  simply_menu_add_items(self, snapshot->selected_section, snapshot->num_items, cursor,
+                        (uint8_t*) snapshot + snapshot->length - cursor);
+
+  return (MenuIndex) {
+    .section = snapshot->selected_section,
+    .row = snapshot->selected_row,
+  };
+}
+
+bool simply_menu_has_snapshot(void) {
+  return persist_exists(SNAPSHOT_PERSIST_KEY);
+}
+
+bool simply_menu_show_snapshot(SimplyMenu *self) {
+  MenuSnapshot *snapshot = malloc(SNAPSHOT_MAX_SIZE);
+  if (!snapshot) {
+    return false;
+  }
+  const size_t length = persist_read_chunked(SNAPSHOT_PERSIST_KEY, snapshot, SNAPSHOT_MAX_SIZE);
+  if (!is_snapshot_valid(snapshot, length)) {
+    free(snapshot);
+    return false;
+  }
+
+  self->snapshot_window_id = snapshot->window_id;
+  self->snapshot_saved_window_id = snapshot->window_id;
+  self->snapshot_hash = snapshot->hash;
+
+  const MenuIndex selection = load_snapshot(self, snapshot);
+  free(snapshot);
+
+  bool animated = false;
+  window_stack_push(self->window.window, animated);
+  simply_menu_set_selection(self, selection, MenuRowAlignCenter, animated);
+  return true;
+}
+
+void simply_menu_discard_snapshot(SimplyMenu *self) {
+  if (!self->snapshot_window_id) {
+    return;
+  }
+  self->snapshot_window_id = 0;
+  simply_menu_clear(self);
+}
+
+//! Reports the peak and capacity of the text arena in bytes so that its size can be tuned.
+void simply_menu_get_arena_usage(SimplyMenu *self, uint16_t *peak, uint16_t *capacity) {
+  *peak = string_arena_get_peak(&self->menu_layer.text_arena);
+  *capacity = self->menu_layer.text_arena.capacity;
+}
+
+static void apply_colors(SimplyMenu *self) {
+  if (!self->menu_layer.menu_layer) {
+    return;
+  }
+  menu_layer_set_normal_colors(self->menu_layer.menu_layer,
+                               gcolor8_get(self->menu_layer.normal_colors[0]),
+                               gcolor8_get(self->menu_layer.normal_colors[1]));
+  menu_layer_set_highlight_colors(self->menu_layer.menu_layer,
+                                  gcolor8_get(self->menu_layer.highlight_colors[0]),
+                                  gcolor8_get(self->menu_layer.highlight_colors[1]));
+}
+
+/**
+ * Writes the window properties, the menu colors, the section layout and the cached rows around
+ * the selection. Returns the number of bytes written, or 0 if they do not fit or the selected
+ * section is not loaded or is past the sections a snapshot holds.
+ */
+size_t simply_menu_write_snapshot(SimplyMenu *self, uint8_t *buffer, size_t capacity) {
+  const size_t header_length = simply_window_write_snapshot(&self->window, buffer, capacity);
+  const size_t colors_size = sizeof(self->menu_layer.normal_colors) +
+      sizeof(self->menu_layer.highlight_colors);
+  if (!header_length || header_length + colors_size + sizeof(MenuSnapshot) > capacity) {
+    return 0;
+  }
+  uint8_t *cursor = buffer + header_length;
+  memcpy(cursor, self->menu_layer.normal_colors, sizeof(self->menu_layer.normal_colors));
+  memcpy(cursor + sizeof(self->menu_layer.normal_colors), self->menu_layer.highlight_colors,
+         sizeof(self->menu_layer.highlight_colors));
+  cursor += colors_size;
+  const size_t length = write_snapshot(self, (MenuSnapshot*) cursor, buffer + capacity - cursor);
+  return length ? cursor + length - buffer : 0;
+}
+
+bool simply_menu_read_snapshot(SimplyMenu *self, const uint8_t *buffer, size_t length) {
+  simply_menu_clear(self);
+  const size_t header_length = simply_window_read_snapshot(&self->window, buffer, length);
+  const size_t colors_size = sizeof(self->menu_layer.normal_colors) +
+      sizeof(self->menu_layer.highlight_colors);
+  if (!header_length || header_length + colors_size > length) {
+    return false;
+  }
+  const uint8_t *cursor = buffer + header_length;
+  memcpy(self->menu_layer.normal_colors, cursor, sizeof(self->menu_layer.normal_colors));
+  memcpy(self->menu_layer.highlight_colors, cursor + sizeof(self->menu_layer.normal_colors),
+         sizeof(self->menu_layer.highlight_colors));
+  cursor += colors_size;
+  window_set_background_color(self->window.window, gcolor8_get(self->menu_layer.normal_colors[0]));
+  apply_colors(self);
+
+  MenuSnapshot *snapshot = (MenuSnapshot*) cursor;
+  if (!is_snapshot_valid(snapshot, buffer + length - cursor)) {
+    return false;
+  }
+  const MenuIndex selection = load_snapshot(self, snapshot);
+  bool animated = false;
+  simply_menu_set_selection(self, selection, MenuRowAlignCenter, animated);
+  return true;
+}
+
+/**
+ * Keeps the cached rows of the selected section on screen while the phone is asked for the
+ * section and those rows again, so that rows which changed since the snapshot are replaced.
+ */
+static void refresh_selected_section(SimplyMenu *self) {
+  const MenuIndex selection = simply_menu_get_selection(self);
+  SimplyMenuSectionInfo *selected_info = get_section_info(self, selection.section);
+  SimplyMenuSectionInfo info = selected_info ? *selected_info : (SimplyMenuSectionInfo) {};
+  reset_section_infos(self, 0);
+  if (selected_info) {
+    *selected_info = info;
+  }
+  request_menu_section(self, selection.section);
+  for (List1Node *walk = self->menu_layer.items; walk; walk = walk->next) {
+    SimplyMenuItem *item = (SimplyMenuItem*) walk;
+    if (item->section == selection.section) {
+      request_menu_item(self, item->section, item->item);
+    }
+  }
+  mark_dirty(self);
+}
+
+/**
+ * The phone is showing its first menu after the snapshot was shown.
+ * A snapshot of the same window is kept and refreshed, otherwise it is discarded.
+ */
+static void reconcile_snapshot(SimplyMenu *self) {
+  if (!self->snapshot_window_id) {
+    return;
+  }
+  if (self->window.id != self->snapshot_window_id) {
+    self->snapshot_window_id = 0;
+    simply_menu_clear(self);
+    return;
+  }
+  self->snapshot_window_id = 0;
+  refresh_selected_section(self);
+}
+
+/**
+ * Ends the diff of a menu shown from the launch snapshot of instant launch.
+ */
+void simply_menu_reconcile(SimplyMenu *self) {
+  if (!self->window.is_reconciling) {
+    return;
+  }
+  self->window.is_reconciling = false;
+  refresh_selected_section(self);
+}
+
 static bool send_menu_selection(SimplyMenu *self) {
   MenuIndex menu_index = simply_menu_get_selection(self);
   return send_menu_item(CommandMenuSelectionEvent, menu_index.section, menu_index.row);
@@ -274,18 +1004,25 @@ static uint16_t menu_get_num_sections_callback(MenuLayer *menu_layer, void *data
 
 static uint16_t menu_get_num_rows_callback(MenuLayer *menu_layer, uint16_t section_index, void *data) {
   SimplyMenu *self = data;
-  SimplyMenuSection *section = get_menu_section(self, section_index);
-  return section ? section->num_items : 1;
+  SimplyMenuSectionInfo *info = get_section_info(self, section_index);
+  return info && info->is_loaded ? info->num_items : 1;
 }
 
 static int16_t menu_get_header_height_callback(MenuLayer *menu_layer, uint16_t section_index, void *data) {
   SimplyMenu *self = data;
-  SimplyMenuSection *section = get_menu_section(self, section_index);
-  return section && section->title && section->title != EMPTY_TITLE ? MENU_CELL_BASIC_HEADER_HEIGHT : 0;
+  SimplyMenuSectionInfo *info = get_section_info(self, section_index);
+  return info && info->has_title ? MENU_CELL_BASIC_HEADER_HEIGHT : 0;
 }
 
 static void menu_draw_header_callback(GContext* ctx, const Layer *cell_layer, uint16_t section_index, void *data) {
   SimplyMenu *self = data;
+  MenuDataSection *data_section = get_data_section(self->menu_layer.data, section_index);
+  if (data_section) {
+    menu_cell_basic_header_draw(ctx, cell_layer,
+                                get_data_string(self->menu_layer.data, data_section->title));
+    return;
+  }
+
   SimplyMenuSection *section = get_menu_section(self, section_index);
   if (!section) {
     request_menu_section(self, section_index);
@@ -298,24 +1035,10 @@ static void menu_draw_header_callback(GContext* ctx, const Layer *cell_layer, ui
   menu_cell_basic_header_draw(ctx, cell_layer, section->title);
 }
 
-static void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
-  SimplyMenu *self = data;
-  SimplyMenuSection *section = get_menu_section(self, cell_index->section);
-  if (!section) {
-    request_menu_section(self, cell_index->section);
-    return;
-  }
-
-  SimplyMenuItem *item = get_menu_item(self, cell_index->section, cell_index->row);
-  if (!item) {
-    request_menu_item(self, cell_index->section, cell_index->row);
-    return;
-  }
-
-  list1_remove(&self->menu_layer.items, &item->node);
-  list1_prepend(&self->menu_layer.items, &item->node);
-
-  SimplyImage *image = simply_res_get_image(self->window.simply->res, item->icon);
+static void draw_row(SimplyMenu *self, GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index,
+                     const char *title, const char *subtitle, uint32_t icon) {
+  simply_mark_first_frame(self->window.simply);
+  SimplyImage *image = simply_res_get_image(simply_get_res(self->window.simply), icon);
   GColor8 *palette = NULL;
 
   if (image && image->is_palette_black_and_white) {
@@ -327,13 +1050,43 @@ static void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuI
   }
 
   graphics_context_set_alpha_blended(ctx, true);
-  menu_cell_basic_draw(ctx, cell_layer, item->title, item->subtitle, image ? image->bitmap : NULL);
+  menu_cell_basic_draw(ctx, cell_layer, title, subtitle, image ? image->bitmap : NULL);
 
   if (palette) {
     gbitmap_set_palette(image->bitmap, palette, false);
   }
 }
 
+static void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
+  SimplyMenu *self = data;
+  SimplyMenuData *menu_data = self->menu_layer.data;
+  if (menu_data) {
+    MenuDataItem *data_item = get_data_item(menu_data, cell_index->section, cell_index->row);
+    if (data_item) {
+      draw_row(self, ctx, cell_layer, cell_index, get_data_string(menu_data, data_item->title),
+               get_data_string(menu_data, data_item->subtitle), data_item->icon);
+    }
+    return;
+  }
+
+  SimplyMenuSectionInfo *info = get_section_info(self, cell_index->section);
+  if (!info || !info->is_loaded) {
+    request_menu_section(self, cell_index->section);
+    return;
+  }
+
+  SimplyMenuItem *item = get_menu_item(self, cell_index->section, cell_index->row);
+  if (!item) {
+    request_menu_item(self, cell_index->section, cell_index->row);
+    return;
+  }
+
+  list1_remove(&self->menu_layer.items, &item->node);
+  list1_prepend(&self->menu_layer.items, &item->node);
+
+  draw_row(self, ctx, cell_layer, cell_index, item->title, item->subtitle, item->icon);
+}
+
 static void menu_select_click_callback(MenuLayer *menu_layer, MenuIndex *cell_index, void *data) {
   send_menu_select_click(cell_index->section, cell_index->row);
 }
@@ -388,8 +1141,14 @@ static void window_appear(Window *window) {
 static void window_disappear(Window *window) {
   SimplyMenu *self = window_get_user_data(window);
   if (simply_window_disappear(&self->window)) {
-    simply_res_clear(self->window.simply->res);
-    simply_menu_clear(self);
+    save_snapshot(self);
+#if SIMPLY_MENU_LOG_ARENA
+    uint16_t peak, capacity;
+    simply_menu_get_arena_usage(self, &peak, &capacity);
+    LOG("menu text arena peak %u/%u bytes", peak, capacity);
+#endif
+    simply_res_unpin_all(simply_get_res(self->window.simply));
+    clear_requests(self);
   }
 }
 
@@ -419,10 +1178,21 @@ void simply_menu_clear(SimplyMenu *self) {
     destroy_item(self, (SimplyMenuItem*) self->menu_layer.items);
   }
 
+  clear_requests(self);
+
+  free(self->menu_layer.data);
+  self->menu_layer.data = NULL;
+
+  reset_section_infos(self, 0);
+
   mark_dirty(self);
 }
 
 static void handle_menu_clear_packet(Simply *simply, Packet *data) {
+  if (simply->menu->snapshot_window_id || simply->menu->window.is_reconciling) {
+    // Keep showing the snapshot until the phone reveals which window it is showing
+    return;
+  }
   simply_menu_clear(simply->menu);
 }
 
@@ -434,37 +1204,59 @@ static void handle_menu_clear_section_packet(Simply *simply, Packet *data) {
 static void handle_menu_props_packet(Simply *simply, Packet *data) {
   MenuPropsPacket *packet = (MenuPropsPacket*) data;
   simply_menu_set_num_sections(simply->menu, packet->num_sections);
+  reconcile_snapshot(simply->menu);
+  simply_menu_reconcile(simply->menu);
   window_set_background_color(simply->menu->window.window, gcolor8_get(packet->background_color));
-  menu_layer_set_highlight_colors(simply->menu->menu_layer.menu_layer,
-                                  gcolor8_get(packet->highlight_background_color),
-                                  gcolor8_get(packet->highlight_text_color));
-  menu_layer_set_normal_colors(simply->menu->menu_layer.menu_layer,
-                               gcolor8_get(packet->background_color),
-                               gcolor8_get(packet->text_color));
+  SimplyMenuLayer *menu_layer = &simply->menu->menu_layer;
+  menu_layer->normal_colors[0] = packet->background_color;
+  menu_layer->normal_colors[1] = packet->text_color;
+  menu_layer->highlight_colors[0] = packet->highlight_background_color;
+  menu_layer->highlight_colors[1] = packet->highlight_text_color;
+  apply_colors(simply->menu);
 }
 
 static void handle_menu_section_packet(Simply *simply, Packet *data) {
   MenuSectionPacket *packet = (MenuSectionPacket*) data;
   SimplyMenuSection *section = malloc(sizeof(*section));
+  if (!section) {
+    return;
+  }
   *section = (SimplyMenuSection) {
     .section = packet->section,
     .num_items = packet->num_items,
-    .title = packet->title_length ? strdup2(packet->title) : NULL,
   };
+  set_text(simply->menu, &section->title, packet->title_length ? packet->title : NULL);
   simply_menu_add_section(simply->menu, section);
 }
 
 static void handle_menu_item_packet(Simply *simply, Packet *data) {
   MenuItemPacket *packet = (MenuItemPacket*) data;
-  SimplyMenuItem *item = malloc(sizeof(*item));
-  *item = (SimplyMenuItem) {
-    .section = packet->section,
-    .item = packet->item,
-    .title = packet->title_length ? strdup2(packet->buffer) : NULL,
-    .subtitle = packet->subtitle_length ? strdup2(packet->buffer + packet->title_length + 1) : NULL,
-    .icon = packet->icon,
-  };
-  simply_menu_add_item(simply->menu, item);
+  SimplyMenu *self = simply->menu;
+  SimplyMenuItem *item = alloc_item(self);
+  if (!item) {
+    return;
+  }
+  item->section = packet->section;
+  item->item = packet->item;
+  item->icon = packet->icon;
+  set_text(self, &item->title, packet->title_length ? packet->buffer : NULL);
+  set_text(self, &item->subtitle,
+           packet->subtitle_length ? packet->buffer + packet->title_length + 1 : NULL);
+  simply_menu_add_item(self, item);
+}
+
+static void handle_menu_items_packet(Simply *simply, Packet *data) {
+  MenuItemsPacket *packet = (MenuItemsPacket*) data;
+  simply_menu_add_items(simply->menu, packet->section, packet->num_items, packet->buffer,
+                        packet->packet.length - sizeof(*packet));
+}
+
+static void handle_menu_data_packet(Simply *simply, Packet *data) {
+  MenuDataPacket *packet = (MenuDataPacket*) data;
+  simply_menu_set_data(simply->menu, packet->num_sections, packet->num_items, packet->buffer,
+                       packet->packet.length - sizeof(*packet));
+  // Requests sent after the acknowledgement mean the dataset was lost, such as when it did not fit
+  send_menu_data_ack(packet->version);
 }
 
 static void handle_menu_get_selection_packet(Simply *simply, Packet *data) {
@@ -481,6 +1273,10 @@ static void handle_menu_selection_packet(Simply *simply, Packet *data) {
 }
 
 bool simply_menu_handle_packet(Simply *simply, Packet *packet) {
+  // Menu packets follow the show of a menu, there is nothing to apply them to before
+  if (!simply->menu) {
+    return false;
+  }
   switch (packet->type) {
     case CommandMenuClear:
       handle_menu_clear_packet(simply, packet);
@@ -497,6 +1293,12 @@ bool simply_menu_handle_packet(Simply *simply, Packet *packet) {
     case CommandMenuItem:
       handle_menu_item_packet(simply, packet);
       return true;
+    case CommandMenuItems:
+      handle_menu_items_packet(simply, packet);
+      return true;
+    case CommandMenuData:
+      handle_menu_data_packet(simply, packet);
+      return true;
     case CommandMenuSelection:
       handle_menu_selection_packet(simply, packet);
       return true;
@@ -514,6 +1316,13 @@ SimplyMenu *simply_menu_create(Simply *simply) {
     .menu_layer.num_sections = 1,
   };
 
+  self->menu_layer.item_pool = malloc0(MAX_CACHED_ITEMS * sizeof(SimplyMenuItem));
+  for (int i = 0; self->menu_layer.item_pool && i < MAX_CACHED_ITEMS; ++i) {
+    list1_prepend(&self->menu_layer.free_items, &self->menu_layer.item_pool[i].node);
+  }
+  string_arena_init(&self->menu_layer.text_arena, TEXT_ARENA_SIZE);
+  simply_menu_set_num_sections(self, 1);
+
   simply_window_init(&self->window, simply);
 
   window_set_user_data(self->window.window, self);
@@ -533,6 +1342,16 @@ void simply_menu_destroy(SimplyMenu *self) {
     return;
   }
 
+  simply_menu_clear(self);
+
+  string_arena_deinit(&self->menu_layer.text_arena);
+
+  free(self->menu_layer.item_pool);
+  self->menu_layer.item_pool = NULL;
+
+  free(self->menu_layer.section_infos);
+  self->menu_layer.section_infos = NULL;
+
   simply_window_deinit(&self->window);
 
   free(self);
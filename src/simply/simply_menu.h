@@ -7,6 +7,7 @@
 #include "simply.h"
 
 #include "util/list1.h"
+#include "util/string_arena.h"
 
 #include <pebble.h>
 
@@ -18,6 +19,12 @@ typedef struct SimplyMenuSection SimplyMenuSection;
 
 typedef struct SimplyMenuItem SimplyMenuItem;
 
+typedef struct SimplyMenuSectionInfo SimplyMenuSectionInfo;
+
+typedef struct SimplyMenuData SimplyMenuData;
+
+typedef struct SimplyMenuRequest SimplyMenuRequest;
+
 typedef enum SimplyMenuType SimplyMenuType;
 
 enum SimplyMenuType {
@@ -30,12 +37,24 @@ struct SimplyMenuLayer {
   MenuLayer *menu_layer;
   List1Node *sections;
   List1Node *items;
+  List1Node *free_items;
+  SimplyMenuItem *item_pool;
+  StringArena text_arena;
+  List1Node *requests;
+  AppTimer *request_timer;
+  SimplyMenuSectionInfo *section_infos;
+  SimplyMenuData *data;
   uint16_t num_sections;
+  GColor8 normal_colors[2];
+  GColor8 highlight_colors[2];
 };
 
 struct SimplyMenu {
   SimplyWindow window;
   SimplyMenuLayer menu_layer;
+  uint32_t snapshot_window_id;
+  uint32_t snapshot_saved_window_id;
+  uint32_t snapshot_hash;
 };
 
 typedef struct SimplyMenuCommon SimplyMenuCommon;
@@ -59,6 +78,21 @@ struct SimplyMenuSection {
   uint16_t num_items;
 };
 
+// Layout metadata kept for every section, independent of the evictable section cache
+struct SimplyMenuSectionInfo {
+  uint16_t num_items;
+  bool is_loaded:1;
+  bool has_title:1;
+};
+
+// An offline dataset uploaded as a whole: a section table, an item table and a string table
+struct SimplyMenuData {
+  uint16_t num_sections;
+  uint16_t num_items;
+  uint16_t strings_length;
+  uint8_t buffer[];
+};
+
 struct SimplyMenuItem {
   SimplyMenuCommonMember;
   char *subtitle;
@@ -66,7 +100,28 @@ struct SimplyMenuItem {
   uint16_t item;
 };
 
+struct SimplyMenuRequest {
+  List1Node node;
+  uint32_t sent_time;
+  uint16_t section;
+  uint16_t item;
+  SimplyMenuType type:8;
+  uint8_t num_retries;
+  bool is_sent;
+};
+
 SimplyMenu *simply_menu_create(Simply *simply);
 void simply_menu_destroy(SimplyMenu *self);
 
+bool simply_menu_has_snapshot(void);
+bool simply_menu_show_snapshot(SimplyMenu *self);
+void simply_menu_discard_snapshot(SimplyMenu *self);
+
+void simply_menu_reconcile(SimplyMenu *self);
+
+void simply_menu_get_arena_usage(SimplyMenu *self, uint16_t *peak, uint16_t *capacity);
+
+size_t simply_menu_write_snapshot(SimplyMenu *self, uint8_t *buffer, size_t capacity);
+bool simply_menu_read_snapshot(SimplyMenu *self, const uint8_t *buffer, size_t length);
+
 bool simply_menu_handle_packet(Simply *simply, Packet *packet);
@@ -20,6 +20,8 @@
 
 #define SEND_DELAY_MS 10
 
+#define WELCOME_DELAY_MS 10000
+
 static const size_t APP_MSG_SIZE_INBOUND = 2044;
 
 static const size_t APP_MSG_SIZE_OUTBOUND = 512;
@@ -55,9 +57,29 @@ struct __attribute__((__packed__)) ImagePacket {
   uint32_t id;
   int16_t width;
   int16_t height;
+  GBitmapFormat format:8;
   uint8_t pixels[];
 };
 
+typedef struct ImageBandPacket ImageBandPacket;
+
+struct __attribute__((__packed__)) ImageBandPacket {
+  Packet packet;
+  uint32_t id;
+  uint16_t row;
+  uint16_t num_rows;
+  uint8_t pixels[];
+};
+
+typedef struct ResPreloadPacket ResPreloadPacket;
+
+struct __attribute__((__packed__)) ResPreloadPacket {
+  Packet packet;
+  uint8_t num_images;
+  uint8_t num_fonts;
+  uint32_t ids[];
+};
+
 typedef struct VibePacket VibePacket;
 
 struct __attribute__((__packed__)) VibePacket {
@@ -153,7 +175,25 @@ static void handle_segment_packet(Simply *simply, Packet *data) {
 
 static void handle_image_packet(Simply *simply, Packet *data) {
   ImagePacket *packet = (ImagePacket*) data;
-  simply_res_add_image(simply->res, packet->id, packet->width, packet->height, packet->pixels);
+  simply_res_add_image(simply_get_res(simply), packet->id, packet->width, packet->height,
+                       packet->format, packet->pixels, packet->packet.length - sizeof(*packet));
+}
+
+static void handle_image_band_packet(Simply *simply, Packet *data) {
+  ImageBandPacket *packet = (ImageBandPacket*) data;
+  simply_res_set_image_rows(simply_get_res(simply), packet->id, packet->row, packet->num_rows,
+                            packet->pixels, packet->packet.length - sizeof(*packet));
+}
+
+static void handle_res_preload_packet(Simply *simply, Packet *data) {
+  ResPreloadPacket *packet = (ResPreloadPacket*) data;
+  const size_t num_ids = (packet->packet.length - sizeof(*packet)) / sizeof(packet->ids[0]);
+  if (packet->num_images + packet->num_fonts > num_ids) {
+    return;
+  }
+  const uint8_t *ids = (uint8_t*) packet + sizeof(*packet);
+  simply_res_preload(simply_get_res(simply), ids, packet->num_images,
+                     ids + packet->num_images * sizeof(uint32_t), packet->num_fonts);
 }
 
 static void handle_vibe_packet(Simply *simply, Packet *data) {
@@ -182,6 +222,12 @@ static bool simply_base_handle_packet(Simply *simply, Packet *packet) {
     case CommandImagePacket:
       handle_image_packet(simply, packet);
       return true;
+    case CommandImageBand:
+      handle_image_band_packet(simply, packet);
+      return true;
+    case CommandResPreload:
+      handle_res_preload_packet(simply, packet);
+      return true;
     case CommandVibe:
       handle_vibe_packet(simply, packet);
       return true;
@@ -232,16 +278,25 @@ static void received_callback(DictionaryIterator *iter, void *context) {
 
     buffer += packet->length;
   }
+
+  // The packets the phone sent along with the show of a launch window arrive in one message
+  Simply *simply = context;
+  simply_window_stack_finish_reconcile(simply->window_stack);
 }
 
 static void dropped_callback(AppMessageResult reason, void *context) {
 }
 
 static void sent_callback(DictionaryIterator *iter, void *context) {
+  Simply *simply = context;
+  simply->msg->is_outbox_busy = false;
+  simply_accel_flush(simply->accel);
 }
 
 static void failed_callback(DictionaryIterator *iter, AppMessageResult reason, void *context) {
   Simply *simply = context;
+  simply->msg->is_outbox_busy = false;
+  simply_accel_flush(simply->accel);
 
   if (reason == APP_MSG_NOT_CONNECTED) {
     s_has_communicated = false;
@@ -252,7 +307,11 @@ static void failed_callback(DictionaryIterator *iter, AppMessageResult reason, v
 
 void simply_msg_show_disconnected(SimplyMsg *self) {
   Simply *simply = self->simply;
-  SimplyUi *ui = simply->ui;
+  SimplyWindowStack *window_stack = simply_get_window_stack(simply);
+  SimplyUi *ui = (SimplyUi*) simply_window_stack_get_window(window_stack, WindowTypeCard);
+  if (!ui) {
+    return;
+  }
 
   simply_ui_clear(ui, ~0);
   simply_ui_set_text(ui, UiSubtitle, "Disconnected");
@@ -260,11 +319,19 @@ void simply_msg_show_disconnected(SimplyMsg *self) {
 
   if (window_stack_get_top_window() != ui->window.window) {
     bool was_broadcast = simply_window_stack_set_broadcast(false);
-    simply_window_stack_show(simply->window_stack, &ui->window, true);
+    simply_window_stack_show(window_stack, &ui->window, true);
     simply_window_stack_set_broadcast(was_broadcast);
   }
 }
 
+static void show_welcome_text(void *data) {
+  if (simply_msg_has_communicated()) {
+    return;
+  }
+
+  simply_msg_show_disconnected(data);
+}
+
 SimplyMsg *simply_msg_create(Simply *simply) {
   if (s_msg) {
     return s_msg;
@@ -285,6 +352,8 @@ SimplyMsg *simply_msg_create(Simply *simply) {
   app_message_register_outbox_sent(sent_callback);
   app_message_register_outbox_failed(failed_callback);
 
+  app_timer_register(WELCOME_DELAY_MS, show_welcome_text, self);
+
   return self;
 }
 
@@ -306,7 +375,19 @@ static bool send_msg(uint8_t *buffer, size_t length) {
     return false;
   }
   dict_write_data(iter, 0, buffer, length);
-  return (app_message_outbox_send() == APP_MSG_OK);
+  if (app_message_outbox_send() != APP_MSG_OK) {
+    return false;
+  }
+  s_msg->is_outbox_busy = true;
+  return true;
+}
+
+/**
+ * Whether nothing is queued or waiting on the outbox, for streams that send their next packet
+ * only once the previous one was delivered.
+ */
+bool simply_msg_is_send_idle(void) {
+  return (s_msg && !s_msg->send_queue && !s_msg->send_buffer && !s_msg->is_outbox_busy);
 }
 
 bool simply_msg_send(uint8_t *buffer, size_t length) {
@@ -18,6 +18,7 @@ struct SimplyMsg {
   AppTimer *send_timer;
   uint8_t *send_buffer;
   size_t send_length;
+  bool is_outbox_busy;
 };
 
 typedef struct SimplyPacket SimplyPacket;
@@ -42,5 +43,7 @@ void simply_msg_destroy(SimplyMsg *self);
 bool simply_msg_has_communicated();
 void simply_msg_show_disconnected(SimplyMsg *self);
 
+bool simply_msg_is_send_idle(void);
+
 bool simply_msg_send(uint8_t *buffer, size_t length);
 bool simply_msg_send_packet(Packet *packet);
@@ -20,16 +20,24 @@ enum Command {
   CommandClick,
   CommandLongClick,
   CommandImagePacket,
+  CommandImageUnloaded,
+  CommandImageBand,
+  CommandResPreload,
   CommandCardClear,
   CommandCardText,
+  CommandCardTextEdit,
+  CommandCardTextReset,
   CommandCardImage,
   CommandCardStyle,
   CommandVibe,
   CommandLight,
+  CommandInstantLaunch,
   CommandAccelPeek,
   CommandAccelConfig,
   CommandAccelData,
   CommandAccelTap,
+  CommandAccelFeatures,
+  CommandAccelGesture,
   CommandMenuClear,
   CommandMenuClearSection,
   CommandMenuProps,
@@ -37,6 +45,10 @@ enum Command {
   CommandMenuGetSection,
   CommandMenuItem,
   CommandMenuGetItem,
+  CommandMenuItems,
+  CommandMenuGetItems,
+  CommandMenuData,
+  CommandMenuDataAck,
   CommandMenuSelection,
   CommandMenuGetSelection,
   CommandMenuSelectionEvent,
@@ -1,20 +1,116 @@
 #include "simply_res.h"
 
+#include "simply_msg.h"
+
 #include "util/color.h"
 #include "util/graphics.h"
+#include "util/math.h"
 #include "util/memory.h"
 #include "util/window.h"
 
 #include <pebble.h>
 
+#define IMAGE_BUDGET_PERCENT 50
+
+#define IMAGE_HEAP_RESERVE 4096
+
+#define FONT_HEAP_RESERVE 2048
+
+#define PRELOAD_INTERVAL_MS 10
+
+#ifdef SIMPLY_RESOURCE_MANIFEST
+#include "resource_manifest.auto.h"
+
+static const SimplyResInfo s_resource_manifest[] = RESOURCE_MANIFEST;
+#endif
+
+typedef struct ImageUnloadedPacket ImageUnloadedPacket;
+
+struct __attribute__((__packed__)) ImageUnloadedPacket {
+  Packet packet;
+  uint32_t id;
+};
+
+static bool send_image_unloaded(uint32_t id) {
+  ImageUnloadedPacket packet = {
+    .packet.type = CommandImageUnloaded,
+    .packet.length = sizeof(packet),
+    .id = id,
+  };
+  return simply_msg_send_packet(&packet.packet);
+}
+
 static bool id_filter(List1Node *node, void *data) {
   return (((SimplyResItemCommon*) node)->id == (uint32_t)(uintptr_t) data);
 }
 
+static uint8_t get_bits_per_pixel(GBitmapFormat format) {
+  switch (format) {
+    case GBitmapFormat8Bit: return 8;
+    case GBitmapFormat2BitPalette: return 2;
+    case GBitmapFormat4BitPalette: return 4;
+    default: return 1;
+  }
+}
+
+static uint16_t get_palette_size(GBitmapFormat format) {
+  switch (format) {
+    case GBitmapFormat1BitPalette:
+    case GBitmapFormat2BitPalette:
+    case GBitmapFormat4BitPalette:
+      return (1 << get_bits_per_pixel(format)) * sizeof(GColor8);
+    default:
+      return 0;
+  }
+}
+
+static uint16_t get_row_size(GBitmapFormat format, int16_t width) {
+  if (format == GBitmapFormat1Bit) {
+    // 1-bit rows are word aligned
+    return (width + 31) / 32 * 4;
+  }
+  return (width * get_bits_per_pixel(format) + 7) / 8;
+}
+
+static size_t get_image_size(SimplyImage *image) {
+  GRect bounds = gbitmap_get_bounds(image->bitmap);
+  return sizeof(*image) + gbitmap_get_bytes_per_row(image->bitmap) * bounds.size.h +
+      (image->palette ? get_palette_size(gbitmap_get_format(image->bitmap)) : 0);
+}
+
+static void update_image_size(SimplyRes *self, SimplyImage *image) {
+  self->images_size -= image->size;
+  image->size = get_image_size(image);
+  self->images_size += image->size;
+}
+
 static void destroy_image(SimplyRes *self, SimplyImage *image) {
   list1_remove(&self->images, &image->node);
+  self->images_size -= image->size;
   gbitmap_destroy(image->bitmap);
   free(image->palette);
+  free(image);
+}
+
+static void evict_image(SimplyRes *self, SimplyImage *image) {
+  if (image->id > self->num_bundled_res) {
+    send_image_unloaded(image->id);
+  }
+  destroy_image(self, image);
+}
+
+static void touch_image(SimplyRes *self, SimplyImage *image) {
+  list1_remove(&self->images, &image->node);
+  list1_prepend(&self->images, &image->node);
+  image->pin_generation = self->pin_generation;
+}
+
+static size_t get_image_budget(SimplyRes *self) {
+  const size_t available = self->images_size + heap_bytes_free();
+  if (available <= IMAGE_HEAP_RESERVE) {
+    return 0;
+  }
+  return MIN(available - IMAGE_HEAP_RESERVE, available * IMAGE_BUDGET_PERCENT / 100);
 }
 
 static void destroy_font(SimplyRes *self, SimplyFont *font) {
@@ -23,10 +119,54 @@ static void destroy_font(SimplyRes *self, SimplyFont *font) {
   free(font);
 }
 
+static bool unreferenced_font_filter(List1Node *node, void *data) {
+  return (((SimplyFont*) node)->ref_count == 0);
+}
+
+/**
+ * Unreferenced fonts stay cached for the next user and are only unloaded when
+ * the heap runs low. Returns whether a font was unloaded.
+ */
+static bool trim_fonts(SimplyRes *self, bool force) {
+  bool did_trim = false;
+  while (force || heap_bytes_free() < FONT_HEAP_RESERVE) {
+    SimplyFont *font = (SimplyFont*) list1_find(self->fonts, unreferenced_font_filter, NULL);
+    if (!font) {
+      break;
+    }
+    destroy_font(self, font);
+    did_trim = true;
+  }
+  return did_trim;
+}
+
+/**
+ * Evicts the least recently used images until the incoming size fits in the budget.
+ * Images used since the last window transition are pinned and never evicted.
+ */
+static void trim_images(SimplyRes *self, size_t incoming_size) {
+  trim_fonts(self, false);
+  const size_t budget = get_image_budget(self);
+  while (self->images_size + incoming_size > budget) {
+    SimplyImage *lru_image = NULL;
+    for (List1Node *walk = self->images; walk; walk = walk->next) {
+      SimplyImage *image = (SimplyImage*) walk;
+      if (image->pin_generation != self->pin_generation) {
+        lru_image = image;
+      }
+    }
+    if (!lru_image) {
+      break;
+    }
+    evict_image(self, lru_image);
+  }
+}
+
+
 static void setup_image(SimplyImage *image) {
   image->is_palette_black_and_white = gbitmap_is_palette_black_and_white(image->bitmap);
 
-  if (!image->is_palette_black_and_white) {
+  if (!image->is_palette_black_and_white || image->palette) {
     return;
   }
 
@@ -37,7 +177,28 @@ static void setup_image(SimplyImage *image) {
   image->palette = palette_copy;
 }
 
-SimplyImage *simply_res_add_bundled_image(SimplyRes *self, uint32_t id) {
+static size_t get_bundled_image_size(const SimplyResInfo *info) {
+#ifdef PBL_COLOR
+  const GBitmapFormat format = (info->bpp == 1 ? GBitmapFormat1BitPalette :
+                                info->bpp == 2 ? GBitmapFormat2BitPalette :
+                                info->bpp == 4 ? GBitmapFormat4BitPalette : GBitmapFormat8Bit);
+#else
+  const GBitmapFormat format = GBitmapFormat1Bit;
+#endif
+  return get_row_size(format, info->width) * info->height + get_palette_size(format);
+}
+
+static bool is_resource_type(SimplyRes *self, uint32_t id, SimplyResType type) {
+  const SimplyResInfo *info = simply_res_get_info(self, id);
+  return (!info || info->type == type);
+}
+
+static SimplyImage *load_bundled_image(SimplyRes *self, uint32_t id) {
+  const SimplyResInfo *info = simply_res_get_info(self, id);
+  if (info && info->width) {
+    trim_images(self, get_bundled_image_size(info));
+  }
+
   SimplyImage *image = malloc(sizeof(*image));
   if (!image) {
     return NULL;
@@ -52,40 +213,122 @@ SimplyImage *simply_res_add_bundled_image(SimplyRes *self, uint32_t id) {
   *image = (SimplyImage) {
     .id = id,
     .bitmap = bitmap,
+    .pin_generation = self->pin_generation,
   };
 
   list1_prepend(&self->images, &image->node);
 
   setup_image(image);
+  update_image_size(self, image);
+  trim_images(self, 0);
 
-  window_stack_schedule_top_window_render();
+  return image;
+}
 
+SimplyImage *simply_res_add_bundled_image(SimplyRes *self, uint32_t id) {
+  SimplyImage *image = load_bundled_image(self, id);
+  if (image) {
+    window_stack_schedule_top_window_render();
+  }
   return image;
 }
 
-SimplyImage *simply_res_add_image(SimplyRes *self, uint32_t id, int16_t width, int16_t height, uint8_t *pixels) {
+SimplyImage *simply_res_add_image(SimplyRes *self, uint32_t id, int16_t width, int16_t height,
+                                  GBitmapFormat format, uint8_t *pixels, size_t length) {
+#ifndef PBL_COLOR
+  if (format != GBitmapFormat1Bit) {
+    return NULL;
+  }
+#endif
+
+  if (width < 0 || height < 0) {
+    return NULL;
+  }
+  const uint16_t palette_size = get_palette_size(format);
+  const uint16_t row_size_bytes = get_row_size(format, width);
+  if (palette_size > length) {
+    return NULL;
+  }
+  // Without pixel rows, the bitmap is only allocated and its rows arrive in image bands
+  const bool has_pixels = ((size_t) palette_size + (size_t) height * row_size_bytes <= length);
+  GColor8 *palette = (GColor8*) pixels;
+  pixels += palette_size;
+
   SimplyImage *image = (SimplyImage*) list1_find(self->images, id_filter, (void*)(uintptr_t) id);
 
   if (image) {
-    free(gbitmap_get_data(image->bitmap));
-    uint16_t row_size_bytes = gbitmap_get_bytes_per_row(image->bitmap);
-    gbitmap_set_data(image->bitmap, pixels, GBitmapFormat1Bit, row_size_bytes, true);
-    image->bitmap_data = pixels;
+    GRect bounds = gbitmap_get_bounds(image->bitmap);
+    if (bounds.size.w != width || bounds.size.h != height ||
+        gbitmap_get_format(image->bitmap) != format ||
+        gbitmap_get_bytes_per_row(image->bitmap) != row_size_bytes) {
+      // The pixels belong to the packet, so the bitmap needs its own buffer of the new size. It
+      // starts blank like a new bitmap for the rows that have not arrived in bands yet.
+      uint8_t *data = malloc0((size_t) height * row_size_bytes);
+      if (!data) {
+        return NULL;
+      }
+      free(gbitmap_get_data(image->bitmap));
+      gbitmap_set_data(image->bitmap, data, format, row_size_bytes, true);
+      gbitmap_set_bounds(image->bitmap, GRect(0, 0, width, height));
+      image->bitmap_data = data;
+    }
+    if (palette_size) {
+      GColor8 *palette_copy = realloc(image->palette, palette_size);
+      if (!palette_copy) {
+        return NULL;
+      }
+      memcpy(palette_copy, palette, palette_size);
+      gbitmap_set_palette(image->bitmap, palette_copy, false);
+      image->palette = palette_copy;
+    } else if (image->palette) {
+      free(image->palette);
+      image->palette = NULL;
+    }
+    if (has_pixels) {
+      memcpy(image->bitmap_data, pixels, height * row_size_bytes);
+    }
+    setup_image(image);
+    touch_image(self, image);
+    update_image_size(self, image);
   } else {
+    trim_images(self, sizeof(*image) + palette_size + height * row_size_bytes);
+
     image = malloc(sizeof(*image));
     if (!image) {
       return NULL;
     }
-    *image = (SimplyImage) { .id = id };
+    *image = (SimplyImage) {
+      .id = id,
+      .pin_generation = self->pin_generation,
+    };
+
+    if (palette_size) {
+      image->palette = malloc(palette_size);
+      if (!image->palette) {
+        free(image);
+        return NULL;
+      }
+      memcpy(image->palette, palette, palette_size);
+      image->bitmap = gbitmap_create_blank_with_palette(GSize(width, height), format, image->palette, false);
+    } else {
+      image->bitmap = gbitmap_create_blank(GSize(width, height), format);
+    }
+    if (!image->bitmap) {
+      free(image->palette);
+      free(image);
+      return NULL;
+    }
     list1_prepend(&self->images, &image->node);
 
-    image->bitmap = gbitmap_create_blank(GSize(width, height), GBitmapFormat1Bit);
     image->bitmap_data = gbitmap_get_data(image->bitmap);
-    uint16_t row_size_bytes = gbitmap_get_bytes_per_row(image->bitmap);
-    size_t pixels_size = height * row_size_bytes;
-    memcpy(image->bitmap_data, pixels, pixels_size);
+    const uint16_t bitmap_row_size_bytes = gbitmap_get_bytes_per_row(image->bitmap);
+    for (int16_t y = 0; has_pixels && y < height; ++y) {
+      memcpy(image->bitmap_data + y * bitmap_row_size_bytes, pixels + y * row_size_bytes,
+             MIN(row_size_bytes, bitmap_row_size_bytes));
+    }
 
     setup_image(image);
+    update_image_size(self, image);
   }
 
   window_stack_schedule_top_window_render();
@@ -93,6 +336,34 @@ SimplyImage *simply_res_add_image(SimplyRes *self, uint32_t id, int16_t width, i
   return image;
 }
 
+SimplyImage *simply_res_set_image_rows(SimplyRes *self, uint32_t id, uint16_t row, uint16_t num_rows,
+                                       uint8_t *pixels, size_t length) {
+  SimplyImage *image = (SimplyImage*) list1_find(self->images, id_filter, (void*)(uintptr_t) id);
+  if (!image || !image->bitmap_data) {
+    return NULL;
+  }
+
+  GRect bounds = gbitmap_get_bounds(image->bitmap);
+  const uint16_t row_size_bytes = get_row_size(gbitmap_get_format(image->bitmap), bounds.size.w);
+  const uint16_t bitmap_row_size_bytes = gbitmap_get_bytes_per_row(image->bitmap);
+  if (row + num_rows > bounds.size.h || num_rows * row_size_bytes > length) {
+    return NULL;
+  }
+
+  uint8_t *row_data = image->bitmap_data + row * bitmap_row_size_bytes;
+  for (uint16_t y = 0; y < num_rows; ++y) {
+    memcpy(row_data, pixels, MIN(row_size_bytes, bitmap_row_size_bytes));
+    row_data += bitmap_row_size_bytes;
+    pixels += row_size_bytes;
+  }
+
+  touch_image(self, image);
+
+  window_stack_schedule_top_window_render();
+
+  return image;
+}
+
 void simply_res_remove_image(SimplyRes *self, uint32_t id) {
   SimplyImage *image = (SimplyImage*) list1_find(self->images, id_filter, (void*)(uintptr_t) id);
   if (image) {
@@ -106,18 +377,22 @@ SimplyImage *simply_res_auto_image(SimplyRes *self, uint32_t id, bool is_placeho
   }
   SimplyImage *image = (SimplyImage*) list1_find(self->images, id_filter, (void*)(uintptr_t) id);
   if (image) {
+    touch_image(self, image);
     return image;
   }
   if (id <= self->num_bundled_res) {
-    return simply_res_add_bundled_image(self, id);
+    return is_resource_type(self, id, SimplyResTypeImage) ?
+        simply_res_add_bundled_image(self, id) : NULL;
   }
   if (is_placeholder) {
-    return simply_res_add_image(self, id, 0, 0, NULL);
+    return simply_res_add_image(self, id, 0, 0, GBitmapFormat1Bit, NULL, 0);
   }
   return NULL;
 }
 
-GFont simply_res_add_custom_font(SimplyRes *self, uint32_t id) {
+static SimplyFont *load_custom_font(SimplyRes *self, uint32_t id) {
+  trim_fonts(self, false);
+
   SimplyFont *font = malloc(sizeof(*font));
   if (!font) {
     return NULL;
@@ -125,38 +400,157 @@ GFont simply_res_add_custom_font(SimplyRes *self, uint32_t id) {
 
   ResHandle handle = resource_get_handle(id);
   if (!handle) {
+    free(font);
     return NULL;
   }
 
   GFont custom_font = fonts_load_custom_font(handle);
+  if (!custom_font && trim_fonts(self, true)) {
+    custom_font = fonts_load_custom_font(handle);
+  }
   if (!custom_font) {
     free(font);
     return NULL;
   }
 
-  font->font = custom_font;
+  *font = (SimplyFont) {
+    .id = id,
+    .font = custom_font,
+  };
 
   list1_prepend(&self->fonts, &font->node);
 
-  window_stack_schedule_top_window_render();
+  return font;
+}
 
-  return font->font;
+static SimplyFont *add_custom_font(SimplyRes *self, uint32_t id) {
+  SimplyFont *font = load_custom_font(self, id);
+  if (font) {
+    window_stack_schedule_top_window_render();
+  }
+  return font;
 }
 
-GFont simply_res_auto_font(SimplyRes *self, uint32_t id) {
+static SimplyFont *auto_font(SimplyRes *self, uint32_t id) {
   if (!id) {
     return NULL;
   }
   SimplyFont *font = (SimplyFont*) list1_find(self->fonts, id_filter, (void*)(uintptr_t) id);
   if (font) {
-    return font->font;
+    return font;
   }
   if (id <= self->num_bundled_res) {
-    return simply_res_add_custom_font(self, id);
+    return is_resource_type(self, id, SimplyResTypeFont) ? add_custom_font(self, id) : NULL;
   }
   return NULL;
 }
 
+GFont simply_res_add_custom_font(SimplyRes *self, uint32_t id) {
+  SimplyFont *font = (SimplyFont*) list1_find(self->fonts, id_filter, (void*)(uintptr_t) id);
+  if (!font) {
+    font = add_custom_font(self, id);
+  }
+  return font ? font->font : NULL;
+}
+
+GFont simply_res_auto_font(SimplyRes *self, uint32_t id) {
+  SimplyFont *font = auto_font(self, id);
+  return font ? font->font : NULL;
+}
+
+GFont simply_res_acquire_font(SimplyRes *self, uint32_t id) {
+  SimplyFont *font = auto_font(self, id);
+  if (!font) {
+    return NULL;
+  }
+  ++font->ref_count;
+  return font->font;
+}
+
+void simply_res_release_font(SimplyRes *self, uint32_t id) {
+  if (!id) {
+    return;
+  }
+  SimplyFont *font = (SimplyFont*) list1_find(self->fonts, id_filter, (void*)(uintptr_t) id);
+  if (font && font->ref_count) {
+    --font->ref_count;
+  }
+}
+
+static void preload_timer_callback(void *context) {
+  SimplyRes *self = context;
+  self->preload_timer = NULL;
+
+  while (self->preload_index < self->num_preloads) {
+    const SimplyResPreload *preload = &self->preloads[self->preload_index++];
+    const uint32_t id = preload->id;
+    if (!id || id > self->num_bundled_res || !is_resource_type(self, id, preload->type)) {
+      continue;
+    }
+    if (preload->type == SimplyResTypeImage) {
+      SimplyImage *image = (SimplyImage*) list1_find(self->images, id_filter, (void*)(uintptr_t) id);
+      if (image) {
+        touch_image(self, image);
+        continue;
+      }
+      load_bundled_image(self, id);
+    } else {
+      if (list1_find(self->fonts, id_filter, (void*)(uintptr_t) id)) {
+        continue;
+      }
+      load_custom_font(self, id);
+    }
+    // Load one resource per timer event so that input and drawing are not held up
+    self->preload_timer = app_timer_register(PRELOAD_INTERVAL_MS, preload_timer_callback, self);
+    return;
+  }
+
+  free(self->preloads);
+  self->preloads = NULL;
+  self->num_preloads = 0;
+  self->preload_index = 0;
+}
+
+static void append_preloads(SimplyRes *self, const void *ids, size_t num_ids, SimplyResType type) {
+  for (size_t i = 0; i < num_ids; ++i) {
+    SimplyResPreload *preload = &self->preloads[self->num_preloads++];
+    *preload = (SimplyResPreload) { .type = type };
+    memcpy(&preload->id, (const uint8_t*) ids + i * sizeof(uint32_t), sizeof(uint32_t));
+  }
+}
+
+/**
+ * Queues bundled images and fonts to be loaded one at a time from a timer so that the next window
+ * does not block on them when it first draws. The id arrays may be unaligned packet data.
+ */
+void simply_res_preload(SimplyRes *self, const void *image_ids, size_t num_images,
+                        const void *font_ids, size_t num_fonts) {
+  const size_t num_pending = self->num_preloads - self->preload_index;
+  const size_t num_preloads = num_pending + num_images + num_fonts;
+  if (num_preloads == num_pending) {
+    return;
+  }
+
+  SimplyResPreload *preloads = malloc(num_preloads * sizeof(*preloads));
+  if (!preloads) {
+    return;
+  }
+  if (num_pending) {
+    memcpy(preloads, &self->preloads[self->preload_index], num_pending * sizeof(*preloads));
+  }
+  free(self->preloads);
+  self->preloads = preloads;
+  self->num_preloads = num_pending;
+  self->preload_index = 0;
+
+  append_preloads(self, image_ids, num_images, SimplyResTypeImage);
+  append_preloads(self, font_ids, num_fonts, SimplyResTypeFont);
+
+  if (!self->preload_timer) {
+    self->preload_timer = app_timer_register(PRELOAD_INTERVAL_MS, preload_timer_callback, self);
+  }
+}
+
 void simply_res_clear(SimplyRes *self) {
   while (self->images) {
     destroy_image(self, (SimplyImage*) self->images);
@@ -167,18 +561,47 @@ void simply_res_clear(SimplyRes *self) {
   }
 }
 
+void simply_res_unpin_all(SimplyRes *self) {
+  ++self->pin_generation;
+}
+
+/**
+ * Returns the build time description of a bundled resource, or NULL when the app was built
+ * without a resource manifest.
+ */
+const SimplyResInfo *simply_res_get_info(SimplyRes *self, uint32_t id) {
+#ifdef RESOURCE_MANIFEST_COUNT
+  if (id && id <= RESOURCE_MANIFEST_COUNT) {
+    return &s_resource_manifest[id - 1];
+  }
+#endif
+  return NULL;
+}
+
 SimplyRes *simply_res_create() {
   SimplyRes *self = malloc(sizeof(*self));
   *self = (SimplyRes) { .images = NULL };
 
+#ifdef RESOURCE_MANIFEST_COUNT
+  self->num_bundled_res = RESOURCE_MANIFEST_COUNT;
+#else
   while (resource_get_handle(self->num_bundled_res + 1)) {
     ++self->num_bundled_res;
   }
+#endif
 
   return self;
 }
 
 void simply_res_destroy(SimplyRes *self) {
+  if (!self) {
+    return;
+  }
+
+  if (self->preload_timer) {
+    app_timer_cancel(self->preload_timer);
+  }
+  free(self->preloads);
   simply_res_clear(self);
   free(self);
 }
@@ -9,12 +9,44 @@
 
 #define simply_res_get_font(self, id) simply_res_auto_font(self, id)
 
+typedef enum SimplyResType SimplyResType;
+
+enum SimplyResType {
+  SimplyResTypeUnknown = 0,
+  SimplyResTypeRaw,
+  SimplyResTypeImage,
+  SimplyResTypeFont,
+};
+
+typedef struct SimplyResInfo SimplyResInfo;
+
+struct SimplyResInfo {
+  SimplyResType type:8;
+  uint8_t bpp;
+  uint16_t width;
+  uint16_t height;
+  uint32_t size;
+};
+
+typedef struct SimplyResPreload SimplyResPreload;
+
+struct SimplyResPreload {
+  uint32_t id;
+  SimplyResType type;
+};
+
 typedef struct SimplyRes SimplyRes;
 
 struct SimplyRes {
   List1Node *images;
   List1Node *fonts;
   uint32_t num_bundled_res;
+  size_t images_size;
+  SimplyResPreload *preloads;
+  AppTimer *preload_timer;
+  uint16_t num_preloads;
+  uint16_t preload_index;
+  uint16_t pin_generation;
 };
 
 typedef struct SimplyResItemCommon SimplyResItemCommon;
@@ -39,6 +71,8 @@ struct SimplyImage {
   uint8_t *bitmap_data;
   GBitmap *bitmap;
   GColor8 *palette;
+  size_t size;
+  uint16_t pin_generation;
   bool is_palette_black_and_white:1;
 };
 
@@ -47,17 +81,29 @@ typedef struct SimplyFont SimplyFont;
 struct SimplyFont {
   SimplyResItemCommonMember;
   GFont font;
+  uint16_t ref_count;
 };
 
 SimplyRes *simply_res_create();
 void simply_res_destroy(SimplyRes *self);
 void simply_res_clear(SimplyRes *self);
+void simply_res_unpin_all(SimplyRes *self);
 
 SimplyImage *simply_res_add_bundled_image(SimplyRes *self, uint32_t id);
-SimplyImage *simply_res_add_image(SimplyRes *self, uint32_t id, int16_t width, int16_t height, uint8_t *pixels);
+SimplyImage *simply_res_add_image(SimplyRes *self, uint32_t id, int16_t width, int16_t height,
+                                  GBitmapFormat format, uint8_t *pixels, size_t length);
+SimplyImage *simply_res_set_image_rows(SimplyRes *self, uint32_t id, uint16_t row, uint16_t num_rows,
+                                       uint8_t *pixels, size_t length);
 SimplyImage *simply_res_auto_image(SimplyRes *self, uint32_t id, bool is_placeholder);
 
 GFont simply_res_add_custom_font(SimplyRes *self, uint32_t id);
 GFont simply_res_auto_font(SimplyRes *self, uint32_t id);
+GFont simply_res_acquire_font(SimplyRes *self, uint32_t id);
+void simply_res_release_font(SimplyRes *self, uint32_t id);
 
 void simply_res_remove_image(SimplyRes *self, uint32_t id);
+
+void simply_res_preload(SimplyRes *self, const void *image_ids, size_t num_images,
+                        const void *font_ids, size_t num_fonts);
+
+const SimplyResInfo *simply_res_get_info(SimplyRes *self, uint32_t id);
@@ -8,6 +8,7 @@
 
 void layer_update_callback(Layer *layer, GContext *ctx) {
   SimplySplash *self = (SimplySplash*) window_get_user_data((Window*) layer);
+  simply_mark_first_frame(self->simply);
 
   GRect frame = layer_get_frame(layer);
 
@@ -100,6 +100,39 @@ struct __attribute__((__packed__)) ElementAnimateDonePacket {
   uint32_t id;
 };
 
+typedef struct ElementSnapshot ElementSnapshot;
+
+struct __attribute__((__packed__)) ElementSnapshot {
+  uint32_t id;
+  SimplyElementType type:8;
+  GRect frame;
+  GColor8 background_color;
+  GColor8 border_color;
+  uint16_t radius;
+};
+
+typedef struct TextElementSnapshot TextElementSnapshot;
+
+// Snapshots can be persisted across launches, so a system font is kept by its key. The key follows
+// the text, both null terminated.
+struct __attribute__((__packed__)) TextElementSnapshot {
+  uint32_t custom_font;
+  TimeUnits time_units:8;
+  GColor8 text_color;
+  GTextOverflowMode overflow_mode:8;
+  GTextAlignment alignment:8;
+  uint16_t text_length;
+  uint8_t font_key_length;
+  char text[];
+};
+
+typedef struct ImageElementSnapshot ImageElementSnapshot;
+
+struct __attribute__((__packed__)) ImageElementSnapshot {
+  uint32_t image;
+  GCompOp compositing:8;
+};
+
 static void simply_stage_clear(SimplyStage *self);
 
 static void simply_stage_update(SimplyStage *self);
@@ -142,6 +175,9 @@ static void destroy_element(SimplyStage *self, SimplyElementCommon *element) {
     default: break;
     case SimplyElementTypeText:
       free(((SimplyElementText*) element)->text);
+      free(((SimplyElementText*) element)->font_key);
+      simply_res_release_font(simply_get_res(self->window.simply),
+                              ((SimplyElementText*) element)->custom_font);
       break;
     case SimplyElementTypeInverter:
       inverter_layer_destroy(((SimplyElementInverter*) element)->inverter_layer);
@@ -224,7 +260,7 @@ static void text_element_draw(GContext *ctx, SimplyStage *self, SimplyElementTex
 static void image_element_draw(GContext *ctx, SimplyStage *self, SimplyElementImage *element) {
   graphics_context_set_compositing_mode(ctx, element->compositing);
   rect_element_draw_background(ctx, self, (SimplyElementRect*) element);
-  SimplyImage *image = simply_res_get_image(self->window.simply->res, element->image);
+  SimplyImage *image = simply_res_get_image(simply_get_res(self->window.simply), element->image);
   if (image && image->bitmap) {
     GRect frame = element->frame;
     if (frame.size.w == 0 && frame.size.h == 0) {
@@ -238,6 +274,7 @@ static void image_element_draw(GContext *ctx, SimplyStage *self, SimplyElementIm
 
 static void layer_update_callback(Layer *layer, GContext *ctx) {
   SimplyStage *self = *(void**) layer_get_data(layer);
+  simply_mark_first_frame(self->window.simply);
 
   GRect frame = layer_get_frame(layer);
   frame.origin = scroll_layer_get_content_offset(self->window.scroll_layer);
@@ -306,6 +343,12 @@ SimplyElementCommon *simply_stage_auto_element(SimplyStage *self, uint32_t id, S
   if (element) {
     return element;
   }
+  element = (SimplyElementCommon*) list1_find(
+      self->stage_layer.held_elements, id_filter, (void*)(uintptr_t) id);
+  if (element && element->type == type) {
+    list1_remove(&self->stage_layer.held_elements, &element->node);
+    return element;
+  }
   element = alloc_element(type);
   if (!element) {
     return NULL;
@@ -421,6 +464,155 @@ SimplyAnimation *simply_stage_animate_element(SimplyStage *self,
   return animation;
 }
 
+static size_t get_element_snapshot_size(SimplyElementCommon *element) {
+  switch (element->type) {
+    case SimplyElementTypeText: {
+      const SimplyElementText *text_element = (SimplyElementText*) element;
+      return sizeof(ElementSnapshot) + sizeof(TextElementSnapshot) +
+          (text_element->text ? strlen(text_element->text) : 0) + 1 +
+          (text_element->font_key ? strlen(text_element->font_key) : 0) + 1;
+    }
+    case SimplyElementTypeImage:
+      return sizeof(ElementSnapshot) + sizeof(ImageElementSnapshot);
+    default:
+      return sizeof(ElementSnapshot);
+  }
+}
+
+/**
+ * Writes the window properties and every element in drawing order. Running animations are
+ * written at their current frame. Returns the number of bytes written, or 0 if they do not fit.
+ */
+size_t simply_stage_write_snapshot(SimplyStage *self, uint8_t *buffer, size_t capacity) {
+  uint8_t *cursor = buffer;
+  uint8_t *end = buffer + capacity;
+  const size_t header_length = simply_window_write_snapshot(&self->window, cursor, capacity);
+  if (!header_length || header_length + sizeof(uint16_t) > capacity) {
+    return 0;
+  }
+  cursor += header_length;
+  const uint16_t num_elements = list1_size(self->stage_layer.elements);
+  memcpy(cursor, &num_elements, sizeof(num_elements));
+  cursor += sizeof(num_elements);
+
+  for (List1Node *walk = self->stage_layer.elements; walk; walk = walk->next) {
+    SimplyElementCommon *element = (SimplyElementCommon*) walk;
+    if (cursor + get_element_snapshot_size(element) > end) {
+      return 0;
+    }
+    ElementSnapshot *snapshot = (ElementSnapshot*) cursor;
+    *snapshot = (ElementSnapshot) {
+      .id = element->id,
+      .type = element->type,
+      .frame = element->frame,
+      .background_color = element->background_color,
+      .border_color = element->border_color,
+    };
+    if (element->type != SimplyElementTypeInverter) {
+      snapshot->radius = ((SimplyElementRect*) element)->radius;
+    }
+    cursor += sizeof(*snapshot);
+    if (element->type == SimplyElementTypeText) {
+      SimplyElementText *text_element = (SimplyElementText*) element;
+      TextElementSnapshot *text_snapshot = (TextElementSnapshot*) cursor;
+      *text_snapshot = (TextElementSnapshot) {
+        .custom_font = text_element->custom_font,
+        .time_units = text_element->time_units,
+        .text_color = text_element->text_color,
+        .overflow_mode = text_element->overflow_mode,
+        .alignment = text_element->alignment,
+        .text_length = text_element->text ? strlen(text_element->text) : 0,
+        .font_key_length = text_element->font_key ? strlen(text_element->font_key) : 0,
+      };
+      memcpy(text_snapshot->text, text_element->text ? text_element->text : "",
+             text_snapshot->text_length + 1);
+      memcpy(text_snapshot->text + text_snapshot->text_length + 1,
+             text_element->font_key ? text_element->font_key : "",
+             text_snapshot->font_key_length + 1);
+      cursor += sizeof(*text_snapshot) + text_snapshot->text_length + 1 +
+          text_snapshot->font_key_length + 1;
+    } else if (element->type == SimplyElementTypeImage) {
+      SimplyElementImage *image_element = (SimplyElementImage*) element;
+      ImageElementSnapshot *image_snapshot = (ImageElementSnapshot*) cursor;
+      *image_snapshot = (ImageElementSnapshot) {
+        .image = image_element->image,
+        .compositing = image_element->compositing,
+      };
+      cursor += sizeof(*image_snapshot);
+    }
+  }
+  return cursor - buffer;
+}
+
+bool simply_stage_read_snapshot(SimplyStage *self, const uint8_t *buffer, size_t length) {
+  const uint8_t *cursor = buffer;
+  const uint8_t *end = buffer + length;
+  simply_stage_clear(self);
+  const size_t header_length = simply_window_read_snapshot(&self->window, cursor, length);
+  if (!header_length || header_length + sizeof(uint16_t) > length) {
+    return false;
+  }
+  cursor += header_length;
+  uint16_t num_elements;
+  memcpy(&num_elements, cursor, sizeof(num_elements));
+  cursor += sizeof(num_elements);
+
+  SimplyRes *res = simply_get_res(self->window.simply);
+  for (uint16_t i = 0; i < num_elements && cursor + sizeof(ElementSnapshot) <= end; ++i) {
+    const ElementSnapshot *snapshot = (const ElementSnapshot*) cursor;
+    cursor += sizeof(*snapshot);
+    SimplyElementCommon *element = simply_stage_auto_element(self, snapshot->id, snapshot->type);
+    if (!element) {
+      return false;
+    }
+    simply_stage_insert_element(self, i, element);
+    simply_stage_set_element_frame(self, element, snapshot->frame);
+    element->background_color = snapshot->background_color;
+    element->border_color = snapshot->border_color;
+    if (element->type != SimplyElementTypeInverter) {
+      ((SimplyElementRect*) element)->radius = snapshot->radius;
+    }
+    if (element->type == SimplyElementTypeText) {
+      const TextElementSnapshot *text_snapshot = (const TextElementSnapshot*) cursor;
+      if (cursor + sizeof(*text_snapshot) > end) {
+        return false;
+      }
+      cursor += sizeof(*text_snapshot) + text_snapshot->text_length + 1 +
+          text_snapshot->font_key_length + 1;
+      if (cursor > end || cursor[-1]) {
+        return false;
+      }
+      const char *font_key = text_snapshot->text + text_snapshot->text_length + 1;
+      SimplyElementText *text_element = (SimplyElementText*) element;
+      text_element->custom_font = text_snapshot->custom_font;
+      strset(&text_element->font_key, font_key);
+      if (text_snapshot->custom_font) {
+        text_element->font = simply_res_acquire_font(res, text_snapshot->custom_font);
+      } else {
+        text_element->font = text_element->font_key ?
+            fonts_get_system_font(text_element->font_key) : NULL;
+      }
+      text_element->time_units = text_snapshot->time_units;
+      text_element->text_color = text_snapshot->text_color;
+      text_element->overflow_mode = text_snapshot->overflow_mode;
+      text_element->alignment = text_snapshot->alignment;
+      strset(&text_element->text, text_snapshot->text);
+    } else if (element->type == SimplyElementTypeImage) {
+      const ImageElementSnapshot *image_snapshot = (const ImageElementSnapshot*) cursor;
+      cursor += sizeof(*image_snapshot);
+      if (cursor > end) {
+        return false;
+      }
+      ((SimplyElementImage*) element)->image = image_snapshot->image;
+      ((SimplyElementImage*) element)->compositing = image_snapshot->compositing;
+    }
+  }
+
+  simply_stage_update_ticker(self);
+  simply_stage_update(self);
+  return true;
+}
+
 static void window_load(Window *window) {
   SimplyStage *self = window_get_user_data(window);
 
@@ -448,8 +640,7 @@ static void window_appear(Window *window) {
 static void window_disappear(Window *window) {
   SimplyStage *self = window_get_user_data(window);
   if (simply_window_disappear(&self->window)) {
-    simply_res_clear(self->window.simply->res);
-    simply_stage_clear(self);
+    simply_res_unpin_all(simply_get_res(self->window.simply));
   }
 }
 
@@ -490,7 +681,47 @@ void simply_stage_update_ticker(SimplyStage *self) {
   }
 }
 
+/**
+ * Sets the elements of a stage shown from the launch snapshot aside instead of destroying them,
+ * so that the elements the phone inserts again keep their text and fonts.
+ */
+static void hold_elements(SimplyStage *self) {
+  simply_window_action_bar_clear(&self->window);
+
+  while (self->stage_layer.elements) {
+    SimplyElementCommon *element = (SimplyElementCommon*) self->stage_layer.elements;
+    simply_stage_remove_element(self, element);
+    list1_prepend(&self->stage_layer.held_elements, &element->node);
+  }
+
+  while (self->stage_layer.animations) {
+    destroy_animation(self, (SimplyAnimation*) self->stage_layer.animations);
+  }
+}
+
+/**
+ * Ends the diff of a stage shown from the launch snapshot. The held elements the phone did not
+ * insert again are destroyed.
+ */
+void simply_stage_reconcile(SimplyStage *self) {
+  if (!self->window.is_reconciling) {
+    return;
+  }
+  self->window.is_reconciling = false;
+  while (self->stage_layer.held_elements) {
+    SimplyElementCommon *element = (SimplyElementCommon*) self->stage_layer.held_elements;
+    list1_remove(&self->stage_layer.held_elements, &element->node);
+    destroy_element(self, element);
+  }
+  simply_stage_update_ticker(self);
+  simply_stage_update(self);
+}
+
 static void handle_stage_clear_packet(Simply *simply, Packet *data) {
+  if (simply->stage->window.is_reconciling) {
+    hold_elements(simply->stage);
+    return;
+  }
   simply_stage_clear(simply->stage);
 }
 
@@ -546,6 +777,9 @@ static void handle_element_text_packet(Simply *simply, Packet *data) {
     element->time_units = packet->time_units;
     simply_stage_update_ticker(simply->stage);
   }
+  if (is_same_string(element->text, packet->text)) {
+    return;
+  }
   strset(&element->text, packet->text);
   simply_stage_update(simply->stage);
 }
@@ -560,9 +794,16 @@ static void handle_element_text_style_packet(Simply *simply, Packet *data) {
   element->overflow_mode = packet->overflow_mode;
   element->alignment = packet->alignment;
   if (packet->custom_font) {
-    element->font = simply_res_get_font(simply->res, packet->custom_font);
+    GFont font = simply_res_acquire_font(simply_get_res(simply), packet->custom_font);
+    simply_res_release_font(simply_get_res(simply), element->custom_font);
+    element->custom_font = font ? packet->custom_font : 0;
+    element->font = font;
+    strset(&element->font_key, NULL);
   } else if (packet->system_font[0]) {
+    simply_res_release_font(simply_get_res(simply), element->custom_font);
+    element->custom_font = 0;
     element->font = fonts_get_system_font(packet->system_font);
+    strset(&element->font_key, packet->system_font);
   }
   simply_stage_update(simply->stage);
 }
@@ -591,6 +832,10 @@ static void handle_element_animate_packet(Simply *simply, Packet *data) {
 }
 
 bool simply_stage_handle_packet(Simply *simply, Packet *packet) {
+  // Stage packets follow the show of a window, there is nothing to apply them to before
+  if (!simply->stage) {
+    return false;
+  }
   switch (packet->type) {
     case CommandStageClear:
       handle_stage_clear_packet(simply, packet);
@@ -35,6 +35,8 @@ struct SimplyStageLayer {
   Layer *layer;
   List1Node *elements;
   List1Node *animations;
+  //! Elements cleared by the phone while the launch window is reconciled, reused when inserted again
+  List1Node *held_elements;
 };
 
 struct SimplyStage {
@@ -78,7 +80,9 @@ struct SimplyElementText {
     struct SimplyElementCommonDef;
   };
   char *text;
+  char *font_key;
   GFont font;
+  uint32_t custom_font;
   TimeUnits time_units:8;
   GColor8 text_color;
   GTextOverflowMode overflow_mode:2;
@@ -117,4 +121,9 @@ struct SimplyAnimation {
 SimplyStage *simply_stage_create(Simply *simply);
 void simply_stage_destroy(SimplyStage *self);
 
+void simply_stage_reconcile(SimplyStage *self);
+
+size_t simply_stage_write_snapshot(SimplyStage *self, uint8_t *buffer, size_t capacity);
+bool simply_stage_read_snapshot(SimplyStage *self, const uint8_t *buffer, size_t length);
+
 bool simply_stage_handle_packet(Simply *simply, Packet *packet);
@@ -21,6 +21,14 @@ struct SimplyStyle {
   int custom_body_font_id;
 };
 
+#define TEXT_MIN_CAPACITY 32
+
+#define TEXT_MEASURE_HEIGHT 16000
+
+#define TEXT_BLOCK_MIN_LENGTH 128
+
+#define TEXT_MIN_BLOCKS 8
+
 enum ClearIndex {
   ClearAction = 0,
   ClearText,
@@ -61,6 +69,32 @@ struct __attribute__((__packed__)) CardTextPacket {
   char text[];
 };
 
+typedef enum CardTextEditType CardTextEditType;
+
+enum CardTextEditType {
+  CardTextAppend = 0,
+  CardTextTruncateHead,
+  CardTextReplace,
+};
+
+typedef struct CardTextEditPacket CardTextEditPacket;
+
+struct __attribute__((__packed__)) CardTextEditPacket {
+  Packet packet;
+  uint8_t index;
+  CardTextEditType type:8;
+  uint16_t start;
+  uint16_t length;
+  char text[];
+};
+
+typedef struct CardTextResetPacket CardTextResetPacket;
+
+struct __attribute__((__packed__)) CardTextResetPacket {
+  Packet packet;
+  uint8_t index;
+};
+
 typedef struct CardImagePacket CardImagePacket;
 
 struct __attribute__((__packed__)) CardImagePacket {
@@ -76,6 +110,23 @@ struct __attribute__((__packed__)) CardStylePacket {
   uint8_t style;
 };
 
+typedef struct CardSnapshot CardSnapshot;
+
+struct __attribute__((__packed__)) CardSnapshot {
+  uint32_t imagefields[NumUiImagefields];
+  int8_t style;
+  GColor8 colors[NumUiTextfields];
+  uint16_t lengths[NumUiTextfields];
+  char buffer[];
+};
+
+static void invalidate_layout(SimplyUi *self) {
+  self->ui_layer.layout.is_valid = false;
+  if (self->ui_layer.layer) {
+    layer_mark_dirty(self->ui_layer.layer);
+  }
+}
+
 void simply_ui_clear(SimplyUi *self, uint32_t clear_mask) {
   if (clear_mask & (1 << ClearAction)) {
     simply_window_action_bar_clear(&self->window);
@@ -88,29 +139,301 @@ void simply_ui_clear(SimplyUi *self, uint32_t clear_mask) {
   }
   if (clear_mask & (1 << ClearImage)) {
     memset(self->ui_layer.imagefields, 0, sizeof(self->ui_layer.imagefields));
+    invalidate_layout(self);
   }
 }
 
-void simply_ui_set_style(SimplyUi *self, int style_index) {
+/**
+ * Ends the diff of a card shown from the launch snapshot. The fields a clear was held back for
+ * are cleared unless the phone set them again.
+ */
+void simply_ui_reconcile(SimplyUi *self) {
+  if (!self->window.is_reconciling) {
+    return;
+  }
+  self->window.is_reconciling = false;
+  for (int textfield_id = 0; textfield_id < NumUiTextfields; ++textfield_id) {
+    if ((self->held_clear_mask & (1 << ClearText)) &&
+        !(self->reconciled_fields & (1 << textfield_id)) &&
+        self->ui_layer.textfields[textfield_id].text) {
+      simply_ui_set_text(self, textfield_id, NULL);
+      simply_ui_set_text_color(self, textfield_id, GColor8Black);
+    }
+  }
+  for (int imagefield_id = 0; imagefield_id < NumUiImagefields; ++imagefield_id) {
+    if ((self->held_clear_mask & (1 << ClearImage)) &&
+        !(self->reconciled_fields & (1 << (NumUiTextfields + imagefield_id))) &&
+        self->ui_layer.imagefields[imagefield_id]) {
+      self->ui_layer.imagefields[imagefield_id] = 0;
+      invalidate_layout(self);
+    }
+  }
+  self->held_clear_mask = 0;
+  self->reconciled_fields = 0;
+}
+
+// Only a font whose acquire succeeded holds a reference, so a NULL handle releases nothing
+static void release_body_font(SimplyUi *self) {
   if (self->ui_layer.custom_body_font) {
-    fonts_unload_custom_font(self->ui_layer.custom_body_font);
-    self->ui_layer.custom_body_font = NULL;
+    simply_res_release_font(simply_get_res(self->window.simply),
+                            self->ui_layer.style->custom_body_font_id);
+  }
+  self->ui_layer.custom_body_font = NULL;
+}
+
+void simply_ui_set_style(SimplyUi *self, int style_index) {
+  SimplyRes *res = simply_get_res(self->window.simply);
+  const SimplyStyle *style = &STYLES[style_index];
+  GFont font = simply_res_acquire_font(res, style->custom_body_font_id);
+  release_body_font(self);
+  self->ui_layer.style = style;
+  self->ui_layer.custom_body_font = font;
+  invalidate_layout(self);
+}
+
+static void reset_text_measure(SimplyUi *self, SimplyUiTextfieldId textfield_id, size_t start) {
+  SimplyUiTextMeasure *measure = &self->ui_layer.body_measure;
+  if (textfield_id != UiBody || start >= measure->length) {
+    return;
+  }
+  while (measure->num_blocks) {
+    SimplyUiTextBlock *block = &measure->blocks[measure->num_blocks - 1];
+    if (block->start + block->length < start) {
+      break;
+    }
+    measure->height -= block->height;
+    measure->length = block->start;
+    --measure->num_blocks;
+  }
+}
+
+static int16_t measure_text_height(char *text, size_t start, size_t end, GFont font, int16_t width) {
+  if (end <= start) {
+    return 0;
+  }
+  const char end_char = text[end];
+  text[end] = '\0';
+  GSize size = graphics_text_layout_get_content_size(text + start, font,
+      GRect(0, 0, width, TEXT_MEASURE_HEIGHT), GTextOverflowModeWordWrap, GTextAlignmentLeft);
+  text[end] = end_char;
+  return size.h;
+}
+
+/**
+ * Drops the blocks of the leading text that is about to be removed. Only a block that is cut in
+ * the middle is measured again; the blocks after it just move.
+ */
+static void truncate_text_measure(SimplyUi *self, char *text, size_t length) {
+  SimplyUiTextMeasure *measure = &self->ui_layer.body_measure;
+  if (length >= measure->length) {
+    reset_text_measure(self, UiBody, 0);
+    return;
+  }
+
+  uint16_t num_removed = 0;
+  while (num_removed < measure->num_blocks &&
+         (size_t) measure->blocks[num_removed].start + measure->blocks[num_removed].length + 1 <=
+             length) {
+    ++num_removed;
+  }
+  if (num_removed >= measure->num_blocks) {
+    reset_text_measure(self, UiBody, 0);
+    return;
+  }
+
+  SimplyUiTextBlock *block = &measure->blocks[num_removed];
+  const size_t end = block->start + block->length;
+  if (length >= end) {
+    // Only the newline of the block would remain, which is simpler to measure from scratch
+    reset_text_measure(self, UiBody, 0);
+    return;
+  }
+
+  for (uint16_t i = 0; i < num_removed; ++i) {
+    measure->height -= measure->blocks[i].height;
+  }
+
+  if (block->start < length) {
+    const int16_t height = measure_text_height(text, length, end, measure->font, measure->width);
+    measure->height += height - block->height;
+    block->height = height;
+    block->length = end - length;
+    block->start = length;
+  }
+
+  measure->num_blocks -= num_removed;
+  memmove(measure->blocks, block, measure->num_blocks * sizeof(*block));
+  for (uint16_t i = 0; i < measure->num_blocks; ++i) {
+    measure->blocks[i].start -= length;
+  }
+  measure->length -= length;
+}
+
+static bool add_text_block(SimplyUiTextMeasure *measure, size_t start, size_t length, int16_t height) {
+  if (measure->num_blocks == measure->blocks_capacity) {
+    const uint16_t capacity = MAX(2 * measure->blocks_capacity, TEXT_MIN_BLOCKS);
+    SimplyUiTextBlock *blocks = realloc(measure->blocks, capacity * sizeof(*blocks));
+    if (!blocks) {
+      return false;
+    }
+    measure->blocks = blocks;
+    measure->blocks_capacity = capacity;
+  }
+  measure->blocks[measure->num_blocks++] = (SimplyUiTextBlock) {
+    .start = start,
+    .length = length,
+    .height = height,
+  };
+  measure->length = start + length + 1;
+  measure->height += height;
+  return true;
+}
+
+/**
+ * Measures the body. Word wrapping restarts at every newline, so the body is split at newlines
+ * into blocks of at least TEXT_BLOCK_MIN_LENGTH bytes whose heights add up. Blocks are kept until
+ * an edit reaches them, and the short tail after the last block is measured on every layout.
+ */
+static GSize measure_body(SimplyUi *self, GFont font, int16_t width) {
+  SimplyUiTextfield *body = &self->ui_layer.textfields[UiBody];
+  SimplyUiTextMeasure *measure = &self->ui_layer.body_measure;
+  if (measure->font != font || measure->width != width || measure->length > body->length) {
+    reset_text_measure(self, UiBody, 0);
+    measure->font = font;
+    measure->width = width;
+  }
+
+  char *text = body->text;
+  size_t start = measure->length;
+  for (size_t i = start; i < body->length; ++i) {
+    if (text[i] != '\n' || i - start < TEXT_BLOCK_MIN_LENGTH) {
+      continue;
+    }
+    if (!add_text_block(measure, start, i - start, measure_text_height(text, start, i, font, width))) {
+      break;
+    }
+    start = i + 1;
+  }
+
+  measure->tail_height = measure_text_height(text, measure->length, body->length, font, width);
+
+  return (GSize) {
+    .w = width,
+    .h = measure->height + measure->tail_height,
+  };
+}
+
+static void draw_text_block(GContext *ctx, char *text, size_t start, size_t end, GFont font,
+                            GRect box) {
+  const char end_char = text[end];
+  text[end] = '\0';
+  graphics_draw_text(ctx, text + start, font, box, GTextOverflowModeWordWrap, GTextAlignmentLeft,
+                     NULL);
+  text[end] = end_char;
+}
+
+/**
+ * Draws only the blocks of the body that intersect the visible part of the scroll layer.
+ */
+static void draw_body_blocks(SimplyUi *self, GContext *ctx, const SimplyUiLayout *layout) {
+  SimplyUiTextfield *body = &self->ui_layer.textfields[UiBody];
+  SimplyUiTextMeasure *measure = &self->ui_layer.body_measure;
+  const int16_t visible_top = -scroll_layer_get_content_offset(self->window.scroll_layer).y;
+  const int16_t visible_bottom = visible_top + layout->window_size.h;
+
+  GRect box = layout->body_rect;
+  for (uint16_t i = 0; i < measure->num_blocks && box.origin.y < visible_bottom; ++i) {
+    const SimplyUiTextBlock *block = &measure->blocks[i];
+    box.size.h = block->height;
+    if (box.origin.y + box.size.h > visible_top) {
+      draw_text_block(ctx, body->text, block->start, block->start + block->length,
+                      layout->body_font, box);
+    }
+    box.origin.y += block->height;
+  }
+
+  box.size.h = measure->tail_height;
+  if (box.origin.y < visible_bottom && box.origin.y + box.size.h > visible_top) {
+    draw_text_block(ctx, body->text, measure->length, body->length, layout->body_font, box);
+  }
+}
+
+static bool reserve_text(SimplyUiTextfield *textfield, size_t length) {
+  if (length + 1 <= textfield->capacity) {
+    return true;
+  }
+  size_t capacity = MAX(textfield->capacity, TEXT_MIN_CAPACITY);
+  while (capacity < length + 1) {
+    capacity *= 2;
+  }
+  if (capacity > UINT16_MAX) {
+    return false;
   }
-  self->ui_layer.style = &STYLES[style_index];
-  if (self->ui_layer.style->custom_body_font_id) {
-    self->ui_layer.custom_body_font = fonts_load_custom_font(
-        resource_get_handle(self->ui_layer.style->custom_body_font_id));
+  char *text = realloc(textfield->text, capacity);
+  if (!text) {
+    return false;
   }
-  layer_mark_dirty(self->ui_layer.layer);
+  if (!textfield->text) {
+    text[0] = '\0';
+  }
+  textfield->text = text;
+  textfield->capacity = capacity;
+  return true;
+}
+
+static void free_text(SimplyUiTextfield *textfield) {
+  free(textfield->text);
+  textfield->text = NULL;
+  textfield->length = 0;
+  textfield->capacity = 0;
 }
 
 void simply_ui_set_text(SimplyUi *self, SimplyUiTextfieldId textfield_id, const char *str) {
   SimplyUiTextfield *textfield = &self->ui_layer.textfields[textfield_id];
-  char **str_field = &textfield->text;
-  strset(str_field, str);
-  if (self->ui_layer.layer) {
-    layer_mark_dirty(self->ui_layer.layer);
+  reset_text_measure(self, textfield_id, 0);
+  const size_t length = is_string(str) ? strlen(str) : 0;
+  if (!length || length + 1 < textfield->capacity / 4) {
+    free_text(textfield);
+  }
+  if (length && reserve_text(textfield, length)) {
+    memcpy(textfield->text, str, length + 1);
+    textfield->length = length;
+  }
+  invalidate_layout(self);
+}
+
+/**
+ * Replaces length bytes at start with str, growing the text buffer by doubling. Appending is a
+ * replacement at the end and truncating the head is a replacement at the start with no text.
+ */
+bool simply_ui_replace_text(SimplyUi *self, SimplyUiTextfieldId textfield_id, size_t start,
+                            size_t length, const char *str) {
+  SimplyUiTextfield *textfield = &self->ui_layer.textfields[textfield_id];
+  start = MIN(start, textfield->length);
+  length = MIN(length, textfield->length - start);
+  const size_t str_length = str ? strlen(str) : 0;
+  const size_t new_length = textfield->length - length + str_length;
+  if (!new_length) {
+    simply_ui_set_text(self, textfield_id, NULL);
+    return true;
+  }
+  if (!reserve_text(textfield, new_length)) {
+    return false;
+  }
+
+  if (textfield_id == UiBody && start == 0 && !str_length) {
+    truncate_text_measure(self, textfield->text, length);
+  } else {
+    reset_text_measure(self, textfield_id, start);
   }
+
+  char *text = textfield->text;
+  memmove(&text[start + str_length], &text[start + length], textfield->length - start - length + 1);
+  memcpy(&text[start], str, str_length);
+  textfield->length = new_length;
+
+  invalidate_layout(self);
+  return true;
 }
 
 void simply_ui_set_text_color(SimplyUi *self, SimplyUiTextfieldId textfield_id, GColor8 color) {
@@ -121,177 +444,254 @@ void simply_ui_set_text_color(SimplyUi *self, SimplyUiTextfieldId textfield_id,
   }
 }
 
-static void layer_update_callback(Layer *layer, GContext *ctx) {
-  SimplyUi *self = *(void**) layer_get_data(layer);
+static const int16_t MARGIN_X = 5;
+static const int16_t MARGIN_Y = 2;
+static const int16_t IMAGE_OFFSET_Y = 3;
+
+static GSize get_image_size(SimplyImage *image) {
+  return image ? gbitmap_get_bounds(image->bitmap).size : GSizeZero;
+}
+
+static void update_layout(SimplyUi *self, Layer *layer, SimplyImage **images, GSize window_size) {
+  SimplyUiLayout *layout = &self->ui_layer.layout;
+  *layout = (SimplyUiLayout) {
+    .window_size = window_size,
+    .is_action_bar = self->window.is_action_bar,
+    .is_scrollable = self->window.is_scrollable,
+  };
+  for (int i = 0; i < NumUiImagefields; ++i) {
+    layout->image_sizes[i] = get_image_size(images[i]);
+  }
 
-  GRect window_frame = layer_get_frame(window_get_root_layer(self->window.window));
+  GRect window_frame = { GPointZero, window_size };
   GRect frame = layer_get_frame(layer);
 
   const SimplyStyle *style = self->ui_layer.style;
   GFont title_font = fonts_get_system_font(style->title_font);
-  GFont subtitle_font = fonts_get_system_font(style->subtitle_font);
   GFont body_font = self->ui_layer.custom_body_font ?
       self->ui_layer.custom_body_font : fonts_get_system_font(style->body_font);
 
-  const int16_t margin_x = 5;
-  const int16_t margin_y = 2;
-  const int16_t image_offset_y = 3;
-
   GRect text_frame = frame;
-  text_frame.size.w -= 2 * margin_x;
+  text_frame.size.w -= 2 * MARGIN_X;
   text_frame.size.h += 1000;
-  GPoint cursor = { margin_x, margin_y };
+  GPoint cursor = { MARGIN_X, MARGIN_Y };
 
   if (self->window.is_action_bar) {
     text_frame.size.w -= ACTION_BAR_WIDTH;
     window_frame.size.w -= ACTION_BAR_WIDTH;
   }
 
-  graphics_context_set_text_color(ctx, GColorBlack);
-
   const SimplyUiTextfield *title = &self->ui_layer.textfields[UiTitle];
   const SimplyUiTextfield *subtitle = &self->ui_layer.textfields[UiSubtitle];
   const SimplyUiTextfield *body = &self->ui_layer.textfields[UiBody];
 
-  bool has_title = is_string(title->text);
-  bool has_subtitle = is_string(subtitle->text);
-  bool has_body = is_string(body->text);
-
-  GSize title_size, subtitle_size;
-  GPoint title_pos, subtitle_pos, image_pos = GPointZero;
-  GRect body_rect;
-
-  SimplyImage *title_icon = simply_res_get_image(
-      self->window.simply->res, self->ui_layer.imagefields[UiTitleIcon]);
-  SimplyImage *subtitle_icon = simply_res_get_image(
-      self->window.simply->res, self->ui_layer.imagefields[UiSubtitleIcon]);
-  SimplyImage *body_image = simply_res_get_image(
-      self->window.simply->res, self->ui_layer.imagefields[UiBodyImage]);
-
-  GRect title_icon_bounds;
-  GRect subtitle_icon_bounds;
-  GRect body_image_bounds;
-
-  if (title_icon) {
-    title_icon_bounds = gbitmap_get_bounds(title_icon->bitmap);
-  }
-  if (subtitle_icon) {
-    subtitle_icon_bounds = gbitmap_get_bounds(subtitle_icon->bitmap);
-  }
+  const GSize title_icon_size = layout->image_sizes[UiTitleIcon];
+  const GSize subtitle_icon_size = layout->image_sizes[UiSubtitleIcon];
+  const GSize body_image_size = layout->image_sizes[UiBodyImage];
 
-  if (has_title) {
+  if (is_string(title->text)) {
     GRect title_frame = text_frame;
-    if (title_icon) {
-      title_frame.origin.x += title_icon_bounds.size.w;
-      title_frame.size.w -= title_icon_bounds.size.w;
-    }
-    title_size = graphics_text_layout_get_content_size(title->text,
+    title_frame.origin.x += title_icon_size.w;
+    title_frame.size.w -= title_icon_size.w;
+    GSize title_size = graphics_text_layout_get_content_size(title->text,
         title_font, title_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft);
     title_size.w = title_frame.size.w;
-    title_pos = cursor;
-    if (title_icon) {
-      title_pos.x += title_icon_bounds.size.w;
-    }
+    layout->title_rect = (GRect) { { cursor.x + title_icon_size.w, cursor.y }, title_size };
+    layout->title_icon_frame = (GRect) {
+      .origin = { MARGIN_X, cursor.y + IMAGE_OFFSET_Y },
+      .size = { title_icon_size.w, title_size.h },
+    };
     cursor.y += title_size.h;
   }
 
-  if (has_subtitle) {
+  if (is_string(subtitle->text)) {
     GRect subtitle_frame = text_frame;
-    if (subtitle_icon) {
-      subtitle_frame.origin.x += subtitle_icon_bounds.size.w;
-      subtitle_frame.size.w -= subtitle_icon_bounds.size.w;
-    }
-    subtitle_size = graphics_text_layout_get_content_size(subtitle->text,
+    subtitle_frame.origin.x += subtitle_icon_size.w;
+    subtitle_frame.size.w -= subtitle_icon_size.w;
+    GSize subtitle_size = graphics_text_layout_get_content_size(subtitle->text,
         title_font, subtitle_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft);
     subtitle_size.w = subtitle_frame.size.w;
-    subtitle_pos = cursor;
-    if (subtitle_icon) {
-      subtitle_pos.x += subtitle_icon_bounds.size.w;
-    }
+    layout->subtitle_rect = (GRect) { { cursor.x + subtitle_icon_size.w, cursor.y }, subtitle_size };
+    layout->subtitle_icon_frame = (GRect) {
+      .origin = { MARGIN_X, cursor.y + IMAGE_OFFSET_Y },
+      .size = { subtitle_icon_size.w, subtitle_size.h },
+    };
     cursor.y += subtitle_size.h;
   }
 
-  if (body_image) {
-    body_image_bounds = gbitmap_get_bounds(body_image->bitmap);
-    image_pos = cursor;
-    cursor.y += body_image_bounds.size.h;
+  if (images[UiBodyImage]) {
+    layout->image_frame = (GRect) {
+      .origin = { 0, cursor.y + IMAGE_OFFSET_Y },
+      .size = { window_frame.size.w, body_image_size.h },
+    };
+    cursor.y += body_image_size.h;
   }
 
-  if (has_body) {
-    body_rect = frame;
+  if (is_string(body->text)) {
+    GRect body_rect = frame;
     body_rect.origin = cursor;
     body_rect.size.w = text_frame.size.w;
-    body_rect.size.h -= 2 * margin_y + cursor.y;
-    GSize body_size = graphics_text_layout_get_content_size(body->text,
-        body_font, text_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft);
+    body_rect.size.h -= 2 * MARGIN_Y + cursor.y;
+    GSize body_size = measure_body(self, body_font, text_frame.size.w);
     if (self->window.is_scrollable) {
       body_rect.size = body_size;
-      int16_t new_height = cursor.y + 2 * margin_y + body_size.h;
+      int16_t new_height = cursor.y + 2 * MARGIN_Y + body_size.h;
       frame.size.h = window_frame.size.h > new_height ? window_frame.size.h : new_height;
       layer_set_frame(layer, frame);
       scroll_layer_set_content_size(self->window.scroll_layer, frame.size);
     } else if (!self->ui_layer.custom_body_font && body_size.h > body_rect.size.h) {
       body_font = fonts_get_system_font(FONT_KEY_GOTHIC_18);
     }
+    layout->body_rect = body_rect;
+  }
+
+  layout->body_font = body_font;
+  layout->frame_size = frame.size;
+  layout->is_valid = true;
+}
+
+/**
+ * Returns the cached card layout, measuring the text again only when the text, style, images,
+ * action bar or frame have changed since the last layout.
+ */
+static const SimplyUiLayout *get_layout(SimplyUi *self, Layer *layer, SimplyImage **images) {
+  SimplyUiLayout *layout = &self->ui_layer.layout;
+  GSize window_size = layer_get_frame(window_get_root_layer(self->window.window)).size;
+  GSize frame_size = layer_get_frame(layer).size;
+
+  bool is_valid = (layout->is_valid &&
+                   layout->is_action_bar == self->window.is_action_bar &&
+                   layout->is_scrollable == self->window.is_scrollable &&
+                   gsize_equal(&layout->window_size, &window_size) &&
+                   gsize_equal(&layout->frame_size, &frame_size));
+  for (int i = 0; is_valid && i < NumUiImagefields; ++i) {
+    GSize image_size = get_image_size(images[i]);
+    is_valid = gsize_equal(&layout->image_sizes[i], &image_size);
+  }
+
+  if (!is_valid) {
+    update_layout(self, layer, images, window_size);
+  }
+  return layout;
+}
+
+static void layer_update_callback(Layer *layer, GContext *ctx) {
+  SimplyUi *self = *(void**) layer_get_data(layer);
+  simply_mark_first_frame(self->window.simply);
+
+  SimplyImage *images[NumUiImagefields];
+  for (int i = 0; i < NumUiImagefields; ++i) {
+    images[i] = simply_res_get_image(simply_get_res(self->window.simply),
+                                     self->ui_layer.imagefields[i]);
   }
 
+  const SimplyUiLayout *layout = get_layout(self, layer, images);
+  const SimplyStyle *style = self->ui_layer.style;
+
+  GRect frame = layer_get_frame(layer);
+
   graphics_context_set_fill_color(ctx, GColorBlack);
   graphics_fill_rect(ctx, frame, 0, GCornerNone);
 
   graphics_context_set_fill_color(ctx, gcolor8_get_or(self->window.background_color, GColorWhite));
   graphics_fill_rect(ctx, frame, 4, GCornersAll);
 
+  const SimplyUiTextfield *title = &self->ui_layer.textfields[UiTitle];
+  const SimplyUiTextfield *subtitle = &self->ui_layer.textfields[UiSubtitle];
+  const SimplyUiTextfield *body = &self->ui_layer.textfields[UiBody];
+
+  SimplyImage *title_icon = images[UiTitleIcon];
+  SimplyImage *subtitle_icon = images[UiSubtitleIcon];
+  SimplyImage *body_image = images[UiBodyImage];
+
   if (title_icon) {
-    GRect icon_frame = (GRect) {
-      .origin = { margin_x, title_pos.y + image_offset_y },
-      .size = { title_icon_bounds.size.w, title_size.h }
-    };
     graphics_context_set_alpha_blended(ctx, true);
-    graphics_draw_bitmap_centered(ctx, title_icon->bitmap, icon_frame);
+    graphics_draw_bitmap_centered(ctx, title_icon->bitmap, layout->title_icon_frame);
   }
-  if (has_title) {
+  if (is_string(title->text)) {
     graphics_context_set_text_color(ctx, gcolor8_get_or(title->color, GColorBlack));
-    graphics_draw_text(ctx, title->text, title_font,
-        (GRect) { .origin = title_pos, .size = title_size },
-        GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+    graphics_draw_text(ctx, title->text, fonts_get_system_font(style->title_font),
+        layout->title_rect, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
   }
 
   if (subtitle_icon) {
-    GRect subicon_frame = (GRect) {
-      .origin = { margin_x, subtitle_pos.y + image_offset_y },
-      .size = { subtitle_icon_bounds.size.w, subtitle_size.h }
-    };
     graphics_context_set_alpha_blended(ctx, true);
-    graphics_draw_bitmap_centered(ctx, subtitle_icon->bitmap, subicon_frame);
+    graphics_draw_bitmap_centered(ctx, subtitle_icon->bitmap, layout->subtitle_icon_frame);
   }
-  if (has_subtitle) {
+  if (is_string(subtitle->text)) {
     graphics_context_set_text_color(ctx, gcolor8_get_or(subtitle->color, GColorBlack));
-    graphics_draw_text(ctx, subtitle->text, subtitle_font,
-        (GRect) { .origin = subtitle_pos, .size = subtitle_size },
-        GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+    graphics_draw_text(ctx, subtitle->text, fonts_get_system_font(style->subtitle_font),
+        layout->subtitle_rect, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
   }
 
   if (body_image) {
-    GRect image_frame = (GRect) {
-      .origin = { 0, image_pos.y + image_offset_y },
-      .size = { window_frame.size.w, body_image_bounds.size.h }
-    };
     graphics_context_set_alpha_blended(ctx, true);
-    graphics_draw_bitmap_centered(ctx, body_image->bitmap, image_frame);
+    graphics_draw_bitmap_centered(ctx, body_image->bitmap, layout->image_frame);
   }
-  if (has_body) {
+  if (is_string(body->text)) {
     graphics_context_set_text_color(ctx, gcolor8_get_or(body->color, GColorBlack));
-    graphics_draw_text(ctx, body->text, body_font, body_rect,
-        GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft, NULL);
+    if (layout->is_scrollable) {
+      draw_body_blocks(self, ctx, layout);
+    } else {
+      graphics_draw_text(ctx, body->text, layout->body_font, layout->body_rect,
+          GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft, NULL);
+    }
   }
 }
 
-static void show_welcome_text(SimplyUi *self) {
-  if (simply_msg_has_communicated()) {
-    return;
+/**
+ * Writes the window properties, the style, the images and the text fields. Returns the number
+ * of bytes written, or 0 if they do not fit.
+ */
+size_t simply_ui_write_snapshot(SimplyUi *self, uint8_t *buffer, size_t capacity) {
+  const size_t header_length = simply_window_write_snapshot(&self->window, buffer, capacity);
+  CardSnapshot *snapshot = (CardSnapshot*) (buffer + header_length);
+  size_t length = header_length + sizeof(*snapshot);
+  if (!header_length || length > capacity) {
+    return 0;
+  }
+  *snapshot = (CardSnapshot) {
+    .style = self->ui_layer.style ? self->ui_layer.style - STYLES : -1,
+  };
+  memcpy(snapshot->imagefields, self->ui_layer.imagefields, sizeof(snapshot->imagefields));
+  for (int textfield_id = 0; textfield_id < NumUiTextfields; ++textfield_id) {
+    SimplyUiTextfield *textfield = &self->ui_layer.textfields[textfield_id];
+    if (length + textfield->length + 1 > capacity) {
+      return 0;
+    }
+    memcpy(&snapshot->colors[textfield_id], &textfield->color, sizeof(textfield->color));
+    memcpy(&snapshot->lengths[textfield_id], &textfield->length, sizeof(textfield->length));
+    memcpy(buffer + length, textfield->text ? textfield->text : "", textfield->length + 1);
+    length += textfield->length + 1;
   }
+  return length;
+}
 
-  simply_msg_show_disconnected(self->window.simply->msg);
+bool simply_ui_read_snapshot(SimplyUi *self, const uint8_t *buffer, size_t length) {
+  const size_t header_length = simply_window_read_snapshot(&self->window, buffer, length);
+  const CardSnapshot *snapshot = (const CardSnapshot*) (buffer + header_length);
+  size_t offset = header_length + sizeof(*snapshot);
+  if (!header_length || offset > length) {
+    return false;
+  }
+  if (snapshot->style >= 0 && (size_t) snapshot->style < ARRAY_LENGTH(STYLES)) {
+    simply_ui_set_style(self, snapshot->style);
+  }
+  memcpy(self->ui_layer.imagefields, snapshot->imagefields, sizeof(self->ui_layer.imagefields));
+  for (int textfield_id = 0; textfield_id < NumUiTextfields; ++textfield_id) {
+    uint16_t text_length;
+    memcpy(&text_length, &snapshot->lengths[textfield_id], sizeof(text_length));
+    if (offset + text_length + 1 > length) {
+      return false;
+    }
+    GColor8 color;
+    memcpy(&color, &snapshot->colors[textfield_id], sizeof(color));
+    simply_ui_set_text(self, textfield_id, (const char*) buffer + offset);
+    simply_ui_set_text_color(self, textfield_id, color);
+    offset += text_length + 1;
+  }
+  invalidate_layout(self);
+  return true;
 }
 
 static void window_load(Window *window) {
@@ -321,7 +721,7 @@ static void window_appear(Window *window) {
 static void window_disappear(Window *window) {
   SimplyUi *self = window_get_user_data(window);
   if (simply_window_disappear(&self->window)) {
-    simply_res_clear(self->window.simply->res);
+    simply_res_unpin_all(simply_get_res(self->window.simply));
   }
 }
 
@@ -336,7 +736,14 @@ static void window_unload(Window *window) {
 
 static void handle_card_clear_packet(Simply *simply, Packet *data) {
   CardClearPacket *packet = (CardClearPacket*) data;
-  simply_ui_clear(simply->ui, packet->flags);
+  SimplyUi *self = simply->ui;
+  if (self->window.is_reconciling) {
+    // The fields the phone does not set again are cleared when the reconcile ends
+    self->held_clear_mask |= packet->flags & ~(1 << ClearAction);
+    simply_ui_clear(self, packet->flags & (1 << ClearAction));
+    return;
+  }
+  simply_ui_clear(self, packet->flags);
 }
 
 static void handle_card_text_packet(Simply *simply, Packet *data) {
@@ -345,8 +752,54 @@ static void handle_card_text_packet(Simply *simply, Packet *data) {
   if (textfield_id >= NumUiTextfields) {
     return;
   }
-  simply_ui_set_text(simply->ui, textfield_id, packet->text);
-  simply_ui_set_text_color(simply->ui, textfield_id, packet->color);
+  SimplyUi *self = simply->ui;
+  SimplyUiTextfield *textfield = &self->ui_layer.textfields[textfield_id];
+  if (self->window.is_reconciling) {
+    self->reconciled_fields |= 1 << textfield_id;
+  }
+  if (is_same_string(textfield->text, packet->text) &&
+      textfield->color.argb == packet->color.argb) {
+    return;
+  }
+  simply_ui_set_text(self, textfield_id, packet->text);
+  simply_ui_set_text_color(self, textfield_id, packet->color);
+}
+
+static bool send_card_text_reset(SimplyUiTextfieldId textfield_id) {
+  CardTextResetPacket packet = {
+    .packet.type = CommandCardTextReset,
+    .packet.length = sizeof(packet),
+    .index = textfield_id,
+  };
+  return simply_msg_send_packet(&packet.packet);
+}
+
+static void handle_card_text_edit_packet(Simply *simply, Packet *data) {
+  CardTextEditPacket *packet = (CardTextEditPacket*) data;
+  SimplyUiTextfieldId textfield_id = packet->index;
+  if (textfield_id >= NumUiTextfields) {
+    return;
+  }
+  SimplyUiTextfield *textfield = &simply->ui->ui_layer.textfields[textfield_id];
+  bool is_applied = true;
+  switch (packet->type) {
+    case CardTextAppend:
+      is_applied = simply_ui_replace_text(simply->ui, textfield_id, textfield->length, 0,
+                                          packet->text);
+      break;
+    case CardTextTruncateHead:
+      is_applied = simply_ui_replace_text(simply->ui, textfield_id, 0, packet->length, NULL);
+      break;
+    case CardTextReplace:
+      is_applied = simply_ui_replace_text(simply->ui, textfield_id, packet->start, packet->length,
+                                          packet->text);
+      break;
+  }
+  if (!is_applied) {
+    // Later edits are byte offsets into the phone's text, so both sides start over empty
+    simply_ui_set_text(simply->ui, textfield_id, NULL);
+    send_card_text_reset(textfield_id);
+  }
 }
 
 static void handle_card_image_packet(Simply *simply, Packet *data) {
@@ -355,16 +808,31 @@ static void handle_card_image_packet(Simply *simply, Packet *data) {
   if (imagefield_id >= NumUiImagefields) {
     return;
   }
-  simply->ui->ui_layer.imagefields[imagefield_id] = packet->image;
+  SimplyUi *self = simply->ui;
+  if (self->window.is_reconciling) {
+    self->reconciled_fields |= 1 << (NumUiTextfields + imagefield_id);
+  }
+  if (self->ui_layer.imagefields[imagefield_id] == packet->image) {
+    return;
+  }
+  self->ui_layer.imagefields[imagefield_id] = packet->image;
+  invalidate_layout(self);
   window_stack_schedule_top_window_render();
 }
 
 static void handle_card_style_packet(Simply *simply, Packet *data) {
   CardStylePacket *packet = (CardStylePacket*) data;
+  if (simply->ui->ui_layer.style == &STYLES[packet->style]) {
+    return;
+  }
   simply_ui_set_style(simply->ui, packet->style);
 }
 
 bool simply_ui_handle_packet(Simply *simply, Packet *packet) {
+  // Card packets follow the show of a card, there is nothing to apply them to before
+  if (!simply->ui) {
+    return false;
+  }
   switch (packet->type) {
     case CommandCardClear:
       handle_card_clear_packet(simply, packet);
@@ -372,6 +840,9 @@ bool simply_ui_handle_packet(Simply *simply, Packet *packet) {
     case CommandCardText:
       handle_card_text_packet(simply, packet);
       return true;
+    case CommandCardTextEdit:
+      handle_card_text_edit_packet(simply, packet);
+      return true;
     case CommandCardImage:
       handle_card_image_packet(simply, packet);
       return true;
@@ -397,8 +868,6 @@ SimplyUi *simply_ui_create(Simply *simply) {
     .unload = window_unload,
   });
 
-  app_timer_register(10000, (AppTimerCallback) show_welcome_text, self);
-
   return self;
 }
 
@@ -409,8 +878,10 @@ void simply_ui_destroy(SimplyUi *self) {
 
   simply_ui_clear(self, ~0);
 
-  fonts_unload_custom_font(self->ui_layer.custom_body_font);
-  self->ui_layer.custom_body_font = NULL;
+  release_body_font(self);
+
+  free(self->ui_layer.body_measure.blocks);
+  self->ui_layer.body_measure.blocks = NULL;
 
   simply_window_deinit(&self->window);
 
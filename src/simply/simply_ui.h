@@ -30,9 +30,53 @@ typedef struct SimplyUiTextfield SimplyUiTextfield;
 
 struct SimplyUiTextfield {
   char *text;
+  uint16_t length;
+  uint16_t capacity;
   GColor8 color;
 };
 
+typedef struct SimplyUiTextBlock SimplyUiTextBlock;
+
+//! A run of whole paragraphs of the body and its measured height.
+struct SimplyUiTextBlock {
+  uint16_t start;
+  uint16_t length;
+  int16_t height;
+};
+
+typedef struct SimplyUiTextMeasure SimplyUiTextMeasure;
+
+//! The body split into blocks of paragraphs with cached heights. Blocks before an edit stay
+//! measured, and only the blocks in view are drawn when the card scrolls.
+struct SimplyUiTextMeasure {
+  GFont font;
+  SimplyUiTextBlock *blocks;
+  uint16_t num_blocks;
+  uint16_t blocks_capacity;
+  int16_t width;
+  uint16_t length;
+  int16_t height;
+  int16_t tail_height;
+};
+
+typedef struct SimplyUiLayout SimplyUiLayout;
+
+struct SimplyUiLayout {
+  GRect title_rect;
+  GRect subtitle_rect;
+  GRect title_icon_frame;
+  GRect subtitle_icon_frame;
+  GRect image_frame;
+  GRect body_rect;
+  GFont body_font;
+  GSize window_size;
+  GSize frame_size;
+  GSize image_sizes[NumUiImagefields];
+  bool is_action_bar:1;
+  bool is_scrollable:1;
+  bool is_valid:1;
+};
+
 typedef struct SimplyUiLayer SimplyUiLayer;
 
 struct SimplyUiLayer {
@@ -41,6 +85,8 @@ struct SimplyUiLayer {
   SimplyUiTextfield textfields[3];
   uint32_t imagefields[3];
   GFont custom_body_font;
+  SimplyUiLayout layout;
+  SimplyUiTextMeasure body_measure;
 };
 
 typedef struct SimplyUi SimplyUi;
@@ -48,15 +94,25 @@ typedef struct SimplyUi SimplyUi;
 struct SimplyUi {
   SimplyWindow window;
   SimplyUiLayer ui_layer;
+  //! The clear flags held back while the launch window is reconciled
+  uint8_t held_clear_mask;
+  //! The text fields followed by the image fields the phone set while reconciling
+  uint8_t reconciled_fields;
 };
 
 SimplyUi *simply_ui_create(Simply *simply);
 void simply_ui_destroy(SimplyUi *self);
 
 void simply_ui_clear(SimplyUi *self, uint32_t clear_mask);
+void simply_ui_reconcile(SimplyUi *self);
 
 void simply_ui_set_style(SimplyUi *self, int style_index);
 void simply_ui_set_text(SimplyUi *self, SimplyUiTextfieldId textfield_id, const char *str);
+bool simply_ui_replace_text(SimplyUi *self, SimplyUiTextfieldId textfield_id, size_t start,
+                            size_t length, const char *str);
 void simply_ui_set_text_color(SimplyUi *self, SimplyUiTextfieldId textfield_id, GColor8 color);
 
+size_t simply_ui_write_snapshot(SimplyUi *self, uint8_t *buffer, size_t capacity);
+bool simply_ui_read_snapshot(SimplyUi *self, const uint8_t *buffer, size_t length);
+
 bool simply_ui_handle_packet(Simply *simply, Packet *packet);
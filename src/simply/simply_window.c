@@ -49,6 +49,19 @@ struct __attribute__((__packed__)) ClickPacket {
 
 typedef ClickPacket LongClickPacket;
 
+typedef struct WindowSnapshot WindowSnapshot;
+
+struct __attribute__((__packed__)) WindowSnapshot {
+  uint32_t id;
+  uint32_t action_bar_icons[3];
+  GColor8 background_color;
+  GColor8 action_bar_background_color;
+  uint8_t button_mask;
+  bool is_fullscreen:1;
+  bool is_scrollable:1;
+  bool is_action_bar:1;
+};
+
 
 static GColor8 s_button_palette[] = { { GColorWhiteARGB8 }, { GColorClearARGB8 } };
 
@@ -171,7 +184,9 @@ void simply_window_set_action_bar_icon(SimplyWindow *self, ButtonId button, uint
     return;
   }
 
-  SimplyImage *icon = simply_res_auto_image(self->simply->res, id, true);
+  self->action_bar_icons[button - BUTTON_ID_UP] = id;
+
+  SimplyImage *icon = simply_res_auto_image(simply_get_res(self->simply), id, true);
 
   if (!icon) {
     action_bar_layer_clear_icon(self->action_bar_layer, button);
@@ -191,6 +206,7 @@ void simply_window_set_action_bar_background_color(SimplyWindow *self, GColor8 b
     return;
   }
 
+  self->action_bar_background_color = background_color;
   s_button_palette[0] = gcolor8_equal(background_color, GColorWhite) ? GColor8Black : GColor8White;
 
   action_bar_layer_set_background_color(self->action_bar_layer, gcolor8_get(background_color));
@@ -203,6 +219,7 @@ void simply_window_action_bar_clear(SimplyWindow *self) {
   for (ButtonId button = BUTTON_ID_UP; button <= BUTTON_ID_DOWN; ++button) {
     action_bar_layer_clear_icon(self->action_bar_layer, button);
   }
+  memset(self->action_bar_icons, 0, sizeof(self->action_bar_icons));
 }
 
 void simply_window_set_button(SimplyWindow *self, ButtonId button, bool enable) {
@@ -219,7 +236,7 @@ void simply_window_single_click_handler(ClickRecognizerRef recognizer, void *con
   bool is_enabled = (self->button_mask & (1 << button));
   if (button == BUTTON_ID_BACK && !is_enabled) {
     if (simply_msg_has_communicated()) {
-      simply_window_stack_back(self->simply->window_stack, self);
+      simply_window_stack_back(simply_get_window_stack(self->simply), self);
     } else {
       bool animated = true;
       window_stack_pop(animated);
@@ -274,7 +291,7 @@ bool simply_window_appear(SimplyWindow *self) {
   if (!self->id) {
     return false;
   }
-  simply_window_stack_send_show(self->simply->window_stack, self);
+  simply_window_stack_send_show(simply_get_window_stack(self->simply), self);
   return true;
 }
 
@@ -282,7 +299,7 @@ bool simply_window_disappear(SimplyWindow *self) {
   if (!self->id) {
     return false;
   }
-  simply_window_stack_send_hide(self->simply->window_stack, self);
+  simply_window_stack_send_hide(simply_get_window_stack(self->simply), self);
 
 #ifdef PBL_PLATFORM_BASALT
   simply_window_set_fullscreen(self, true);
@@ -291,6 +308,67 @@ bool simply_window_disappear(SimplyWindow *self) {
   return true;
 }
 
+/**
+ * Prepares a window that was covered to be shown again as it was. Covered windows give up their
+ * status bar and their action bar icons may have been evicted, so both are set again.
+ */
+void simply_window_restore(SimplyWindow *self) {
+  simply_window_set_fullscreen(self, self->is_fullscreen);
+
+  if (!self->is_action_bar) {
+    return;
+  }
+  for (ButtonId button = BUTTON_ID_UP; button <= BUTTON_ID_DOWN; ++button) {
+    simply_window_set_action_bar_icon(self, button, self->action_bar_icons[button - BUTTON_ID_UP]);
+  }
+}
+
+/**
+ * Writes the window properties common to all window types. Returns the number of bytes written,
+ * or 0 if they do not fit.
+ */
+size_t simply_window_write_snapshot(SimplyWindow *self, uint8_t *buffer, size_t capacity) {
+  if (capacity < sizeof(WindowSnapshot)) {
+    return 0;
+  }
+  WindowSnapshot *snapshot = (WindowSnapshot*) buffer;
+  *snapshot = (WindowSnapshot) {
+    .id = self->id,
+    .background_color = self->background_color,
+    .action_bar_background_color = self->action_bar_background_color,
+    .button_mask = self->button_mask,
+    .is_fullscreen = self->is_fullscreen,
+    .is_scrollable = self->is_scrollable,
+    .is_action_bar = self->is_action_bar,
+  };
+  memcpy(snapshot->action_bar_icons, self->action_bar_icons, sizeof(snapshot->action_bar_icons));
+  return sizeof(*snapshot);
+}
+
+size_t simply_window_read_snapshot(SimplyWindow *self, const uint8_t *buffer, size_t length) {
+  if (length < sizeof(WindowSnapshot)) {
+    return 0;
+  }
+  const WindowSnapshot *snapshot = (const WindowSnapshot*) buffer;
+  self->id = snapshot->id;
+  self->button_mask = snapshot->button_mask;
+  self->is_fullscreen = snapshot->is_fullscreen;
+  simply_window_set_background_color(self, snapshot->background_color);
+  simply_window_set_fullscreen(self, snapshot->is_fullscreen);
+  simply_window_set_scrollable(self, snapshot->is_scrollable);
+  simply_window_action_bar_clear(self);
+  if (snapshot->is_action_bar) {
+    simply_window_set_action_bar_background_color(self, snapshot->action_bar_background_color);
+    for (ButtonId button = BUTTON_ID_UP; button <= BUTTON_ID_DOWN; ++button) {
+      uint32_t icon;
+      memcpy(&icon, &snapshot->action_bar_icons[button - BUTTON_ID_UP], sizeof(icon));
+      simply_window_set_action_bar_icon(self, button, icon);
+    }
+    simply_window_set_action_bar(self, true);
+  }
+  return sizeof(*snapshot);
+}
+
 void simply_window_unload(SimplyWindow *self) {
   scroll_layer_destroy(self->scroll_layer);
   self->scroll_layer = NULL;
@@ -303,6 +381,7 @@ static void handle_window_props_packet(Simply *simply, Packet *data) {
     return;
   }
   window->id = packet->id;
+  window->is_fullscreen = packet->fullscreen;
   simply_window_set_background_color(window, packet->background_color);
   simply_window_set_fullscreen(window, packet->fullscreen);
   simply_window_set_scrollable(window, packet->scrollable);
@@ -19,12 +19,16 @@ struct SimplyWindow {
   Layer *layer;
   ActionBarLayer *action_bar_layer;
   uint32_t id;
+  uint32_t action_bar_icons[3];
   ButtonId button_mask:4;
   GColor8 background_color;
+  GColor8 action_bar_background_color;
   bool is_fullscreen:1;
   bool is_scrollable:1;
   bool is_action_bar:1;
   bool is_status_bar:1;
+  //! Shown from the launch snapshot and being diffed against the first show of the phone
+  bool is_reconciling:1;
 };
 
 SimplyWindow *simply_window_init(SimplyWindow *self, Simply *simply);
@@ -36,6 +40,10 @@ void simply_window_load(SimplyWindow *self);
 void simply_window_unload(SimplyWindow *self);
 bool simply_window_appear(SimplyWindow *self);
 bool simply_window_disappear(SimplyWindow *self);
+void simply_window_restore(SimplyWindow *self);
+
+size_t simply_window_write_snapshot(SimplyWindow *self, uint8_t *buffer, size_t capacity);
+size_t simply_window_read_snapshot(SimplyWindow *self, const uint8_t *buffer, size_t length);
 
 void simply_window_single_click_handler(ClickRecognizerRef recognizer, void *context);
 
@@ -1,22 +1,32 @@
 #include "simply_window_stack.h"
 
 #include "simply_window.h"
+#include "simply_stage.h"
+#include "simply_menu.h"
 #include "simply_msg.h"
+#include "simply_ui.h"
 
 #include "simply.h"
 
+#include "util/hash.h"
 #include "util/math.h"
+#include "util/memory.h"
+#include "util/persist.h"
 
 #include <pebble.h>
 
-typedef enum WindowType WindowType;
+#define MAX_WINDOWS_PER_TYPE 3
 
-enum WindowType {
-  WindowTypeWindow = 0,
-  WindowTypeMenu,
-  WindowTypeCard,
-  WindowTypeLast,
-};
+#define WINDOW_HEAP_RESERVE 8192
+
+#define INSTANT_LAUNCH_PERSIST_KEY 999
+
+//! Chunked across consecutive keys, clear of the menu snapshot keys from 1000
+#define LAUNCH_SNAPSHOT_PERSIST_KEY 1100
+
+#define LAUNCH_SNAPSHOT_VERSION 2
+
+#define LAUNCH_SNAPSHOT_MAX_SIZE 1024
 
 typedef struct WindowShowPacket WindowShowPacket;
 
@@ -24,6 +34,7 @@ struct __attribute__((__packed__)) WindowShowPacket {
   Packet packet;
   WindowType type:8;
   bool pushing;
+  uint32_t id;
 };
 
 typedef struct WindowSignalPacket WindowSignalPacket;
@@ -39,7 +50,31 @@ typedef WindowHidePacket WindowEventPacket;
 
 typedef WindowEventPacket WindowShowEventPacket;
 
-typedef WindowEventPacket WindowHideEventPacket;
+typedef struct WindowHideEventPacket WindowHideEventPacket;
+
+struct __attribute__((__packed__)) WindowHideEventPacket {
+  Packet packet;
+  uint32_t id;
+  uint32_t retained_id;
+};
+
+typedef struct InstantLaunchPacket InstantLaunchPacket;
+
+struct __attribute__((__packed__)) InstantLaunchPacket {
+  Packet packet;
+  bool enabled;
+};
+
+typedef struct LaunchSnapshot LaunchSnapshot;
+
+//! The last shown window persisted for the next launch. The window id is in the window snapshot.
+struct __attribute__((__packed__)) LaunchSnapshot {
+  uint16_t version;
+  uint16_t length;
+  uint32_t hash;
+  WindowType type:8;
+  uint8_t buffer[];
+};
 
 static bool s_broadcast_window = true;
 
@@ -59,8 +94,397 @@ static bool send_window_show(SimplyMsg *self, uint32_t id) {
   return send_window(self, CommandWindowShowEvent, id);
 }
 
-static bool send_window_hide(SimplyMsg *self, uint32_t id) {
-  return send_window(self, CommandWindowHideEvent, id);
+static bool send_window_hide(SimplyMsg *self, uint32_t id, uint32_t retained_id) {
+  if (!s_broadcast_window) {
+    return false;
+  }
+  WindowHideEventPacket packet = {
+    .packet.type = CommandWindowHideEvent,
+    .packet.length = sizeof(packet),
+    .id = id,
+    .retained_id = retained_id,
+  };
+  return simply_msg_send_packet(&packet.packet);
+}
+
+static SimplyWindow *create_window(Simply *simply, WindowType type) {
+  switch (type) {
+    case WindowTypeWindow: return (SimplyWindow*) simply_stage_create(simply);
+    case WindowTypeMenu: return (SimplyWindow*) simply_menu_create(simply);
+    case WindowTypeCard: return (SimplyWindow*) simply_ui_create(simply);
+    default: return NULL;
+  }
+}
+
+static void destroy_window(SimplyWindow *window, WindowType type) {
+  switch (type) {
+    case WindowTypeWindow: simply_stage_destroy((SimplyStage*) window); break;
+    case WindowTypeMenu: simply_menu_destroy((SimplyMenu*) window); break;
+    case WindowTypeCard: simply_ui_destroy((SimplyUi*) window); break;
+    default: break;
+  }
+}
+
+static size_t write_window_snapshot(SimplyWindow *window, WindowType type, uint8_t *buffer,
+                                    size_t capacity) {
+  switch (type) {
+    case WindowTypeWindow: return simply_stage_write_snapshot((SimplyStage*) window, buffer, capacity);
+    case WindowTypeMenu: return simply_menu_write_snapshot((SimplyMenu*) window, buffer, capacity);
+    case WindowTypeCard: return simply_ui_write_snapshot((SimplyUi*) window, buffer, capacity);
+    default: return 0;
+  }
+}
+
+static bool read_window_snapshot(SimplyWindow *window, WindowType type, const uint8_t *buffer,
+                                 size_t length) {
+  switch (type) {
+    case WindowTypeWindow: return simply_stage_read_snapshot((SimplyStage*) window, buffer, length);
+    case WindowTypeMenu: return simply_menu_read_snapshot((SimplyMenu*) window, buffer, length);
+    case WindowTypeCard: return simply_ui_read_snapshot((SimplyUi*) window, buffer, length);
+    default: return false;
+  }
+}
+
+static bool snapshot_id_filter(List1Node *node, void *data) {
+  return (((SimplyWindowSnapshot*) node)->id == (uint32_t)(uintptr_t) data);
+}
+
+static void remove_snapshot(SimplyWindowStack *self, SimplyWindowSnapshot *snapshot) {
+  list1_remove(&self->snapshots, &snapshot->node);
+  self->snapshots_size -= snapshot->length;
+}
+
+static void drop_snapshot(SimplyWindowStack *self, uint32_t id) {
+  SimplyWindowSnapshot *snapshot = (SimplyWindowSnapshot*) list1_find(
+      self->snapshots, snapshot_id_filter, (void*)(uintptr_t) id);
+  if (snapshot) {
+    remove_snapshot(self, snapshot);
+    free(snapshot);
+  }
+}
+
+/**
+ * Serializes a back stack window before its instance is given up. The oldest snapshots are
+ * dropped to stay within the budget, and a window that does not fit is left to the phone.
+ */
+static void save_snapshot(SimplyWindowStack *self, SimplyWindowEntry *entry) {
+  SimplyWindow *window = entry->window;
+  if (!window->id || !window_stack_contains_window(window->window)) {
+    return;
+  }
+  drop_snapshot(self, window->id);
+
+  const size_t capacity = MIN(self->snapshot_budget, UINT16_MAX);
+  SimplyWindowSnapshot *snapshot = malloc(sizeof(*snapshot) + capacity);
+  if (!snapshot) {
+    return;
+  }
+  const size_t length = write_window_snapshot(window, entry->type, snapshot->buffer, capacity);
+  if (!length) {
+    free(snapshot);
+    return;
+  }
+  SimplyWindowSnapshot *shrunk_snapshot = realloc(snapshot, sizeof(*snapshot) + length);
+  if (shrunk_snapshot) {
+    snapshot = shrunk_snapshot;
+  }
+  snapshot->node.next = NULL;
+  snapshot->id = window->id;
+  snapshot->shown_at = entry->shown_at;
+  snapshot->type = entry->type;
+  snapshot->length = length;
+
+  while (self->snapshots && self->snapshots_size + length > self->snapshot_budget) {
+    SimplyWindowSnapshot *oldest = (SimplyWindowSnapshot*) list1_last(self->snapshots);
+    remove_snapshot(self, oldest);
+    free(oldest);
+  }
+
+  int index = 0;
+  for (List1Node *walk = self->snapshots; walk; walk = walk->next, ++index) {
+    if (((SimplyWindowSnapshot*) walk)->shown_at < snapshot->shown_at) {
+      break;
+    }
+  }
+  list1_insert(&self->snapshots, index, &snapshot->node);
+  self->snapshots_size += length;
+}
+
+static bool window_filter(List1Node *node, void *data) {
+  return (((SimplyWindowEntry*) node)->window == data);
+}
+
+static bool id_filter(List1Node *node, void *data) {
+  return (((SimplyWindowEntry*) node)->window->id == (uint32_t)(uintptr_t) data);
+}
+
+static SimplyWindowEntry *add_entry(SimplyWindowStack *self, SimplyWindow *window,
+                                    WindowType type) {
+  SimplyWindowEntry *entry = malloc0(sizeof(*entry));
+  if (!entry) {
+    return NULL;
+  }
+  entry->window = window;
+  entry->type = type;
+  list1_append(&self->entries, &entry->node);
+  return entry;
+}
+
+static void destroy_entry(SimplyWindowStack *self, SimplyWindowEntry *entry) {
+  save_snapshot(self, entry);
+  if (window_stack_contains_window(entry->window->window)) {
+    self->is_showing = true;
+    window_stack_remove(entry->window->window, false);
+    self->is_showing = false;
+  }
+  list1_remove(&self->entries, &entry->node);
+  destroy_window(entry->window, entry->type);
+  free(entry);
+}
+
+static void touch_entry(SimplyWindowStack *self, SimplyWindowEntry *entry) {
+  list1_remove(&self->entries, &entry->node);
+  list1_prepend(&self->entries, &entry->node);
+  entry->shown_at = ++self->show_count;
+  self->simply->windows[entry->type] = entry->window;
+}
+
+static bool is_top_entry(SimplyWindowEntry *entry) {
+  return (entry->window->window == window_stack_get_top_window());
+}
+
+static bool is_active_entry(SimplyWindowStack *self, SimplyWindowEntry *entry) {
+  return (self->simply->windows[entry->type] == entry->window);
+}
+
+static size_t count_entries(SimplyWindowStack *self, WindowType type) {
+  size_t count = 0;
+  for (List1Node *walk = self->entries; walk; walk = walk->next) {
+    if (((SimplyWindowEntry*) walk)->type == type) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * Returns the oldest instance of a type that can be given up, or any type when type is
+ * WindowTypeLast. The top window and the instance packets are currently applied to are kept.
+ */
+static SimplyWindowEntry *find_oldest_entry(SimplyWindowStack *self, WindowType type) {
+  SimplyWindowEntry *oldest = NULL;
+  for (List1Node *walk = self->entries; walk; walk = walk->next) {
+    SimplyWindowEntry *entry = (SimplyWindowEntry*) walk;
+    if ((type == WindowTypeLast || entry->type == type) &&
+        !is_top_entry(entry) && !is_active_entry(self, entry)) {
+      oldest = entry;
+    }
+  }
+  return oldest;
+}
+
+/**
+ * The window below the top is the most recently shown instance still in the native stack.
+ */
+static SimplyWindowEntry *find_revealed_entry(SimplyWindowStack *self, SimplyWindow *window) {
+  for (List1Node *walk = self->entries; walk; walk = walk->next) {
+    SimplyWindowEntry *entry = (SimplyWindowEntry*) walk;
+    if (entry->window != window && entry->window->id &&
+        window_stack_contains_window(entry->window->window)) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static void trim_windows(SimplyWindowStack *self) {
+  while (heap_bytes_free() < WINDOW_HEAP_RESERVE) {
+    SimplyWindowEntry *entry = find_oldest_entry(self, WindowTypeLast);
+    if (!entry) {
+      break;
+    }
+    destroy_entry(self, entry);
+  }
+}
+
+/**
+ * Returns the instance to show a window with. The instance already holding the window is
+ * preferred, then an instance that is not in use, then a new one while memory allows, and
+ * finally the oldest retained instance is taken over.
+ */
+static SimplyWindow *acquire_window(SimplyWindowStack *self, WindowType type, uint32_t id) {
+  SimplyWindowEntry *entry = NULL;
+  if (id) {
+    drop_snapshot(self, id);
+    entry = (SimplyWindowEntry*) list1_find(self->entries, id_filter, (void*)(uintptr_t) id);
+    if (entry && entry->type != type) {
+      entry->window->id = 0;
+      entry = NULL;
+    }
+  }
+  if (!entry) {
+    for (List1Node *walk = self->entries; walk; walk = walk->next) {
+      SimplyWindowEntry *unused = (SimplyWindowEntry*) walk;
+      if (unused->type == type && !window_stack_contains_window(unused->window->window)) {
+        entry = unused;
+      }
+    }
+  }
+  if (!entry) {
+    trim_windows(self);
+    if (count_entries(self, type) < MAX_WINDOWS_PER_TYPE &&
+        heap_bytes_free() >= WINDOW_HEAP_RESERVE) {
+      SimplyWindow *window = create_window(self->simply, type);
+      entry = window ? add_entry(self, window, type) : NULL;
+      if (window && !entry) {
+        destroy_window(window, type);
+      }
+    }
+  }
+  if (!entry) {
+    entry = find_oldest_entry(self, type);
+    if (entry) {
+      save_snapshot(self, entry);
+      self->is_showing = true;
+      window_stack_remove(entry->window->window, false);
+      self->is_showing = false;
+    }
+  }
+  if (!entry) {
+    entry = (SimplyWindowEntry*) list1_find(self->entries, window_filter,
+                                            self->simply->windows[type]);
+  }
+  if (!entry) {
+    return self->simply->windows[type];
+  }
+  entry->window->id = id;
+  touch_entry(self, entry);
+  return entry->window;
+}
+
+/**
+ * Returns the instance packets of a type are applied to, creating the first one on demand.
+ */
+SimplyWindow *simply_window_stack_get_window(SimplyWindowStack *self, WindowType type) {
+  SimplyWindow *window = self->simply->windows[type];
+  return window ? window : acquire_window(self, type, 0);
+}
+
+static bool is_launch_snapshot_valid(LaunchSnapshot *snapshot, size_t length) {
+  return (length >= sizeof(*snapshot) && snapshot->version == LAUNCH_SNAPSHOT_VERSION &&
+          snapshot->length >= sizeof(*snapshot) && snapshot->length <= length &&
+          snapshot->type < WindowTypeLast &&
+          snapshot->hash == hash_fnv1a(snapshot->buffer, snapshot->length - sizeof(*snapshot)));
+}
+
+bool simply_window_stack_has_launch_snapshot(void) {
+  return (persist_read_bool(INSTANT_LAUNCH_PERSIST_KEY) &&
+          persist_exists(LAUNCH_SNAPSHOT_PERSIST_KEY));
+}
+
+/**
+ * Shows the last shown window of the previous launch in place of the splash. The window keeps its
+ * id so that the first window the phone shows can be matched against it.
+ */
+bool simply_window_stack_show_launch_snapshot(SimplyWindowStack *self) {
+  LaunchSnapshot *snapshot = malloc(LAUNCH_SNAPSHOT_MAX_SIZE);
+  if (!snapshot) {
+    return false;
+  }
+  const size_t length = persist_read_chunked(LAUNCH_SNAPSHOT_PERSIST_KEY, snapshot,
+                                             LAUNCH_SNAPSHOT_MAX_SIZE);
+  SimplyWindow *window = NULL;
+  if (is_launch_snapshot_valid(snapshot, length)) {
+    window = acquire_window(self, snapshot->type, 0);
+  }
+  if (window) {
+    self->is_showing = true;
+    window_stack_push(window->window, false);
+    if (!read_window_snapshot(window, snapshot->type, snapshot->buffer,
+                              snapshot->length - sizeof(*snapshot))) {
+      window->id = 0;
+      window_stack_remove(window->window, false);
+      window = NULL;
+    }
+    self->is_showing = false;
+  }
+  if (window) {
+    // Back exits until the phone configures the buttons, there is no phone to handle it yet
+    window->button_mask &= ~(1 << BUTTON_ID_BACK);
+    self->launch_window = window;
+    self->launch_type = snapshot->type;
+    self->launch_hash = snapshot->hash;
+  }
+  free(snapshot);
+  return (window != NULL);
+}
+
+/**
+ * Persists the last shown window for the next launch. The write is skipped when it is the same as
+ * the snapshot this launch started with.
+ */
+void simply_window_stack_save_launch_snapshot(SimplyWindowStack *self) {
+  // The disconnected card is made by the watch alone and is not worth showing again
+  if (!self || !simply_msg_has_communicated() ||
+      !persist_read_bool(INSTANT_LAUNCH_PERSIST_KEY)) {
+    return;
+  }
+  SimplyWindowEntry *entry = (SimplyWindowEntry*) self->entries;
+  if (!entry || !entry->window->id) {
+    return;
+  }
+  LaunchSnapshot *snapshot = malloc(LAUNCH_SNAPSHOT_MAX_SIZE);
+  if (!snapshot) {
+    return;
+  }
+  const size_t length = write_window_snapshot(entry->window, entry->type, snapshot->buffer,
+                                              LAUNCH_SNAPSHOT_MAX_SIZE - sizeof(*snapshot));
+  if (length) {
+    *snapshot = (LaunchSnapshot) {
+      .version = LAUNCH_SNAPSHOT_VERSION,
+      .length = sizeof(*snapshot) + length,
+      .hash = hash_fnv1a(snapshot->buffer, length),
+      .type = entry->type,
+    };
+    if (snapshot->hash != self->launch_hash) {
+      persist_write_chunked(LAUNCH_SNAPSHOT_PERSIST_KEY, snapshot, snapshot->length);
+    }
+  } else {
+    // A window too large to persist must not leave an older window to be shown in its place
+    persist_delete_chunked(LAUNCH_SNAPSHOT_PERSIST_KEY, LAUNCH_SNAPSHOT_MAX_SIZE);
+  }
+  free(snapshot);
+}
+
+/**
+ * Ends the diff of the launch window once the packets received along with its show are applied.
+ */
+void simply_window_stack_finish_reconcile(SimplyWindowStack *self) {
+  if (!self || !self->reconcile_window) {
+    return;
+  }
+  SimplyWindow *window = self->reconcile_window;
+  self->reconcile_window = NULL;
+  switch (self->launch_type) {
+    case WindowTypeWindow: simply_stage_reconcile((SimplyStage*) window); break;
+    case WindowTypeMenu: simply_menu_reconcile((SimplyMenu*) window); break;
+    case WindowTypeCard: simply_ui_reconcile((SimplyUi*) window); break;
+    default: break;
+  }
+  window->is_reconciling = false;
+}
+
+/**
+ * The phone showed another window than the launch window, which is taken out of the native stack
+ * so that going back does not reveal it.
+ */
+static void discard_launch_window(SimplyWindowStack *self, SimplyWindow *window) {
+  window->id = 0;
+  if (window_stack_contains_window(window->window)) {
+    self->is_showing = true;
+    window_stack_remove(window->window, false);
+    self->is_showing = false;
+  }
 }
 
 bool simply_window_stack_set_broadcast(bool broadcast) {
@@ -83,20 +507,27 @@ SimplyWindow *simply_window_stack_get_top_window(Simply *simply) {
 
 void simply_window_stack_show(SimplyWindowStack *self, SimplyWindow *window, bool is_push) {
   bool animated = (self->simply->splash == NULL);
+  Window *top_window = window_stack_get_top_window();
+  if (top_window == window->window) {
+    return;
+  }
 
   self->is_showing = true;
-  window_stack_pop_all(!is_push);
-  self->is_showing = false;
-
-  if (is_push) {
-    window_stack_push(self->pusher, false);
+  if (window_stack_contains_window(window->window) && !is_push) {
+    while (window_stack_get_top_window() != window->window) {
+      window_stack_pop(animated);
+    }
+  } else {
+    window_stack_remove(window->window, false);
+    window_stack_push(window->window, animated);
+    if (!is_push && top_window) {
+      window_stack_remove(top_window, false);
+    }
   }
-
-  window_stack_push(window->window, animated);
-
-  if (is_push) {
+  if (window_stack_contains_window(self->pusher)) {
     window_stack_remove(self->pusher, false);
   }
+  self->is_showing = false;
 }
 
 void simply_window_stack_pop(SimplyWindowStack *self, SimplyWindow *window) {
@@ -108,13 +539,58 @@ void simply_window_stack_pop(SimplyWindowStack *self, SimplyWindow *window) {
   self->is_hiding = false;
 }
 
+/**
+ * Rebuilds an evicted back stack window from its snapshot in place of the top window.
+ */
+static void restore_snapshot(SimplyWindowStack *self, SimplyWindow *window,
+                             SimplyWindowSnapshot *snapshot) {
+  remove_snapshot(self, snapshot);
+  const uint32_t id = window->id;
+
+  SimplyWindow *restored = acquire_window(self, snapshot->type, snapshot->id);
+  bool is_restored = false;
+  if (restored) {
+    simply_window_stack_show(self, restored, false);
+    is_restored = read_window_snapshot(restored, snapshot->type, snapshot->buffer,
+                                       snapshot->length);
+  }
+  free(snapshot);
+
+  send_window_hide(self->simply->msg, id, is_restored ? restored->id : 0);
+}
+
 void simply_window_stack_back(SimplyWindowStack *self, SimplyWindow *window) {
+  SimplyWindowEntry *revealed = find_revealed_entry(self, window);
+  SimplyWindowSnapshot *snapshot = (SimplyWindowSnapshot*) self->snapshots;
+  if (window->id && snapshot && (!revealed || snapshot->shown_at > revealed->shown_at)) {
+    restore_snapshot(self, window, snapshot);
+    return;
+  }
+  if (!revealed || !window->id) {
+    self->is_hiding = true;
+    simply_window_stack_send_hide(self, window);
+    self->is_hiding = false;
+    return;
+  }
+
+  send_window_hide(self->simply->msg, window->id, revealed->window->id);
+
   self->is_hiding = true;
-  simply_window_stack_send_hide(self, window);
+  self->is_showing = true;
+  bool animated = true;
+  window_stack_pop(animated);
+  self->is_showing = false;
   self->is_hiding = false;
+
+  touch_entry(self, revealed);
+  simply_window_restore(revealed->window);
 }
 
 void simply_window_stack_send_show(SimplyWindowStack *self, SimplyWindow *window) {
+  SimplyWindowEntry *entry = (SimplyWindowEntry*) list1_find(self->entries, window_filter, window);
+  if (entry) {
+    touch_entry(self, entry);
+  }
   if (self->is_showing) {
     return;
   }
@@ -128,7 +604,7 @@ void simply_window_stack_send_hide(SimplyWindowStack *self, SimplyWindow *window
   if (self->is_showing) {
     return;
   }
-  send_window_hide(self->simply->msg, window->id);
+  send_window_hide(self->simply->msg, window->id, 0);
   if (!self->is_hiding) {
     window_stack_push(self->pusher, false);
   }
@@ -136,18 +612,67 @@ void simply_window_stack_send_hide(SimplyWindowStack *self, SimplyWindow *window
 
 static void handle_window_show_packet(Simply *simply, Packet *data) {
   WindowShowPacket *packet = (WindowShowPacket*) data;
-  SimplyWindow *window = simply->windows[MIN(WindowTypeLast - 1, packet->type)];
-  simply_window_stack_show(simply->window_stack, window, packet->pushing);
+  const WindowType type = MIN(WindowTypeLast - 1, packet->type);
+  SimplyWindowStack *window_stack = simply_get_window_stack(simply);
+  SimplyWindow *launch_window = window_stack->launch_window;
+  window_stack->launch_window = NULL;
+  SimplyWindow *snapshot_menu = window_stack->snapshot_menu;
+  window_stack->snapshot_menu = NULL;
+  if (launch_window && launch_window->id == packet->id && window_stack->launch_type == type) {
+    // The launch window stays on screen and the packets that follow only apply what changed
+    launch_window->is_reconciling = true;
+    window_stack->reconcile_window = launch_window;
+  }
+  SimplyWindow *window = acquire_window(window_stack, type, packet->id);
+  if (window) {
+    simply_window_stack_show(window_stack, window, packet->pushing);
+  }
+  if (launch_window && window != launch_window) {
+    discard_launch_window(window_stack, launch_window);
+  }
+  // A snapshot menu shown again as the same instance is reconciled by its props instead
+  if (snapshot_menu && window != snapshot_menu) {
+    simply_menu_discard_snapshot((SimplyMenu*) snapshot_menu);
+    discard_launch_window(window_stack, snapshot_menu);
+  }
+}
+
+static void handle_instant_launch_packet(Simply *simply, Packet *data) {
+  InstantLaunchPacket *packet = (InstantLaunchPacket*) data;
+  if (persist_read_bool(INSTANT_LAUNCH_PERSIST_KEY) == packet->enabled) {
+    return;
+  }
+  persist_write_bool(INSTANT_LAUNCH_PERSIST_KEY, packet->enabled);
+  if (!packet->enabled) {
+    persist_delete_chunked(LAUNCH_SNAPSHOT_PERSIST_KEY, LAUNCH_SNAPSHOT_MAX_SIZE);
+    if (simply->window_stack) {
+      simply->window_stack->launch_hash = 0;
+    }
+  }
 }
 
 static void handle_window_hide_packet(Simply *simply, Packet *data) {
   WindowHidePacket *packet = (WindowHidePacket*) data;
+  SimplyWindowStack *window_stack = simply->window_stack;
+  if (!window_stack) {
+    return;
+  }
+  drop_snapshot(window_stack, packet->id);
   SimplyWindow *window = simply_window_stack_get_top_window(simply);
   if (!window) {
     return;
   }
   if (window->id == packet->id) {
-    simply_window_stack_pop(simply->window_stack, window);
+    simply_window_stack_pop(window_stack, window);
+    return;
+  }
+  // Windows removed from below the top on the phone are dropped from the native stack too
+  SimplyWindowEntry *entry = packet->id ? (SimplyWindowEntry*) list1_find(
+      window_stack->entries, id_filter, (void*)(uintptr_t) packet->id) : NULL;
+  if (entry && window_stack_contains_window(entry->window->window)) {
+    window_stack->is_showing = true;
+    window_stack_remove(entry->window->window, false);
+    window_stack->is_showing = false;
   }
 }
 
@@ -159,13 +684,19 @@ bool simply_window_stack_handle_packet(Simply *simply, Packet *packet) {
     case CommandWindowHide:
       handle_window_hide_packet(simply, packet);
       return true;
+    case CommandInstantLaunch:
+      handle_instant_launch_packet(simply, packet);
+      return true;
   }
   return false;
 }
 
 SimplyWindowStack *simply_window_stack_create(Simply *simply) {
   SimplyWindowStack *self = malloc(sizeof(*self));
-  *self = (SimplyWindowStack) { .simply = simply };
+  *self = (SimplyWindowStack) {
+    .simply = simply,
+    .snapshot_budget = SIMPLY_WINDOW_SNAPSHOT_BUDGET,
+  };
 
   self->pusher = window_create();
 
@@ -180,5 +711,21 @@ void simply_window_stack_destroy(SimplyWindowStack *self) {
   window_destroy(self->pusher);
   self->pusher = NULL;
 
+  while (self->snapshots) {
+    SimplyWindowSnapshot *snapshot = (SimplyWindowSnapshot*) self->snapshots;
+    remove_snapshot(self, snapshot);
+    free(snapshot);
+  }
+
+  // The active instances are destroyed along with the rest of Simply
+  while (self->entries) {
+    SimplyWindowEntry *entry = (SimplyWindowEntry*) self->entries;
+    list1_remove(&self->entries, &entry->node);
+    if (!is_active_entry(self, entry)) {
+      destroy_window(entry->window, entry->type);
+    }
+    free(entry);
+  }
+
   free(self);
 }
@@ -6,13 +6,68 @@
 
 #include "simply.h"
 
+#include "util/list1.h"
+
 #include <pebble.h>
 
+//! Bytes kept for snapshots of windows evicted from the back stack
+#ifndef SIMPLY_WINDOW_SNAPSHOT_BUDGET
+#define SIMPLY_WINDOW_SNAPSHOT_BUDGET 2048
+#endif
+
+typedef enum WindowType WindowType;
+
+enum WindowType {
+  WindowTypeWindow = 0,
+  WindowTypeMenu,
+  WindowTypeCard,
+  WindowTypeLast,
+};
+
+typedef struct SimplyWindowEntry SimplyWindowEntry;
+
+//! A live window instance. Instances stay in the native window stack when covered so that going
+//! back reveals them as they were without the phone sending them again.
+struct SimplyWindowEntry {
+  List1Node node;
+  SimplyWindow *window;
+  uint32_t shown_at;
+  WindowType type:8;
+};
+
+typedef struct SimplyWindowSnapshot SimplyWindowSnapshot;
+
+//! The serialized state of a back stack window whose instance was evicted, so that going back to
+//! it can rebuild it without the phone.
+struct SimplyWindowSnapshot {
+  List1Node node;
+  uint32_t id;
+  uint32_t shown_at;
+  WindowType type:8;
+  uint16_t length;
+  uint8_t buffer[];
+};
+
 typedef struct SimplyWindowStack SimplyWindowStack;
 
 struct SimplyWindowStack {
   Simply *simply;
   Window *pusher;
+  //! Window instances ordered from the most recently shown
+  List1Node *entries;
+  //! Snapshots ordered from the most recently shown
+  List1Node *snapshots;
+  size_t snapshots_size;
+  size_t snapshot_budget;
+  //! The window shown from the launch snapshot until the phone shows its first window
+  SimplyWindow *launch_window;
+  //! The launch window the phone showed again, diffed until the packets of the show are applied
+  SimplyWindow *reconcile_window;
+  //! The menu shown from the menu snapshot until the phone shows its first window
+  SimplyWindow *snapshot_menu;
+  uint32_t launch_hash;
+  WindowType launch_type:8;
+  uint32_t show_count;
   bool is_showing:1;
   bool is_hiding:1;
 };
@@ -20,6 +75,13 @@ struct SimplyWindowStack {
 SimplyWindowStack *simply_window_stack_create(Simply *simply);
 void simply_window_stack_destroy(SimplyWindowStack *self);
 
+SimplyWindow *simply_window_stack_get_window(SimplyWindowStack *self, WindowType type);
+
+bool simply_window_stack_has_launch_snapshot(void);
+bool simply_window_stack_show_launch_snapshot(SimplyWindowStack *self);
+void simply_window_stack_save_launch_snapshot(SimplyWindowStack *self);
+void simply_window_stack_finish_reconcile(SimplyWindowStack *self);
+
 bool simply_window_stack_set_broadcast(bool broadcast);
 
 SimplyWindow *simply_window_stack_get_top_window(Simply *simply);
@@ -103,6 +103,11 @@ typedef union GColor8 {
   (GBitmapFormat1Bit)
 #endif
 
+#ifndef gbitmap_create_blank_with_palette
+#define gbitmap_create_blank_with_palette(size, format, palette, free_on_destroy) \
+  gbitmap_create_blank(size, format)
+#endif
+
 #ifndef menu_layer_set_normal_colors
 #define menu_layer_set_normal_colors(menu_layer, background_color, text_color)
 #endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Integer math for sensor processing on watches without a floating point unit.
+ */
+
+//! Integer square root, rounded down.
+static inline uint32_t isqrt32(uint32_t value) {
+  uint32_t result = 0;
+  uint32_t bit = 1u << 30;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+//! Clamps a value to the range of a 16-bit sample.
+static inline int16_t saturate_int16(int32_t value) {
+  return value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value;
+}
+
+//! Multiplies by a Q14 fixed point factor, where 1 << 14 is one, rounding to nearest.
+static inline int32_t fixed_mul_q14(int32_t value, int32_t factor) {
+  return ((int64_t) value * factor + (1 << 13)) >> 14;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HASH_FNV1A_INIT 2166136261u
+
+static inline uint32_t hash_fnv1a_continue(uint32_t hash, const void *buffer, size_t length) {
+  const uint8_t *data = buffer;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static inline uint32_t hash_fnv1a(const void *buffer, size_t length) {
+  return hash_fnv1a_continue(HASH_FNV1A_INIT, buffer, length);
+}
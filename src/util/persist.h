@@ -0,0 +1,44 @@
+#pragma once
+
+#include "util/math.h"
+
+#include <pebble.h>
+
+/**
+ * Persistent storage values are limited to PERSIST_DATA_MAX_LENGTH bytes.
+ * The chunked helpers spread a larger buffer across consecutive keys starting at the given key.
+ */
+
+static inline bool persist_write_chunked(uint32_t key, const void *buffer, size_t length) {
+  const uint8_t *data = buffer;
+  for (size_t offset = 0; offset < length; offset += PERSIST_DATA_MAX_LENGTH, ++key) {
+    const size_t size = MIN((size_t) PERSIST_DATA_MAX_LENGTH, length - offset);
+    if (persist_write_data(key, data + offset, size) != (int) size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static inline size_t persist_read_chunked(uint32_t key, void *buffer, size_t length) {
+  uint8_t *data = buffer;
+  size_t offset = 0;
+  for (; offset < length; ++key) {
+    const size_t size = MIN((size_t) PERSIST_DATA_MAX_LENGTH, length - offset);
+    const int read = persist_read_data(key, data + offset, size);
+    if (read <= 0) {
+      break;
+    }
+    offset += read;
+    if ((size_t) read < size) {
+      break;
+    }
+  }
+  return offset;
+}
+
+static inline void persist_delete_chunked(uint32_t key, size_t length) {
+  for (size_t offset = 0; offset < length; offset += PERSIST_DATA_MAX_LENGTH, ++key) {
+    persist_delete(key);
+  }
+}
@@ -8,6 +8,11 @@ static inline bool is_string(const char *str) {
   return str && str[0];
 }
 
+//! Compares two strings where NULL is the same as the empty string.
+static inline bool is_same_string(const char *str, const char *other) {
+  return strcmp(str ? str : "", other ? other : "") == 0;
+}
+
 static inline char *strdup2(const char *str) {
   if (!str) {
     return NULL;
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * A fixed capacity string arena that is compacted instead of fragmenting.
+ * Every string remembers the pointer that owns it so that compaction can move the string
+ * and update its owner. Owners must stay at the same address while they hold a string.
+ */
+
+#define STRING_ARENA_ALIGN(size) (((size) + 3) & ~3)
+
+typedef struct StringArena StringArena;
+
+struct StringArena {
+  uint8_t *buffer;
+  uint16_t capacity;
+  uint16_t used;
+  uint16_t live;
+  uint16_t peak;
+};
+
+typedef struct StringArenaRecord StringArenaRecord;
+
+struct StringArenaRecord {
+  char **owner;
+  uint16_t size;
+  char data[];
+};
+
+static inline bool string_arena_init(StringArena *arena, size_t capacity) {
+  *arena = (StringArena) { .buffer = malloc(capacity) };
+  if (!arena->buffer) {
+    return false;
+  }
+  arena->capacity = capacity;
+  return true;
+}
+
+static inline void string_arena_deinit(StringArena *arena) {
+  free(arena->buffer);
+  *arena = (StringArena) { .buffer = NULL };
+}
+
+//! The most bytes of live strings the arena held at once, for tuning its capacity.
+static inline uint16_t string_arena_get_peak(StringArena *arena) {
+  return arena->peak;
+}
+
+static inline bool string_arena_contains(StringArena *arena, const char *str) {
+  return (str && (const uint8_t*) str >= arena->buffer &&
+          (const uint8_t*) str < arena->buffer + arena->used);
+}
+
+static inline StringArenaRecord *string_arena_get_record(const char *str) {
+  return (StringArenaRecord*) (str - offsetof(StringArenaRecord, data));
+}
+
+static inline void string_arena_free(StringArena *arena, char **owner) {
+  if (!string_arena_contains(arena, *owner)) {
+    return;
+  }
+  StringArenaRecord *record = string_arena_get_record(*owner);
+  record->owner = NULL;
+  arena->live -= record->size;
+  if ((uint8_t*) record + record->size == arena->buffer + arena->used) {
+    arena->used -= record->size;
+  }
+  *owner = NULL;
+}
+
+static inline void string_arena_compact(StringArena *arena) {
+  uint8_t *read = arena->buffer;
+  uint8_t *write = arena->buffer;
+  uint8_t *end = arena->buffer + arena->used;
+  while (read < end) {
+    StringArenaRecord *record = (StringArenaRecord*) read;
+    const uint16_t size = record->size;
+    if (record->owner) {
+      if (write != read) {
+        memmove(write, read, size);
+        record = (StringArenaRecord*) write;
+        *record->owner = record->data;
+      }
+      write += size;
+    }
+    read += size;
+  }
+  arena->used = write - arena->buffer;
+}
+
+static inline char *string_arena_alloc(StringArena *arena, char **owner, size_t length) {
+  const size_t size = STRING_ARENA_ALIGN(sizeof(StringArenaRecord) + length + 1);
+  if (arena->used + size > arena->capacity) {
+    if (arena->live + size > arena->capacity) {
+      return NULL;
+    }
+    string_arena_compact(arena);
+  }
+  StringArenaRecord *record = (StringArenaRecord*) (arena->buffer + arena->used);
+  record->owner = owner;
+  record->size = size;
+  arena->used += size;
+  arena->live += size;
+  if (arena->live > arena->peak) {
+    arena->peak = arena->live;
+  }
+  *owner = record->data;
+  return record->data;
+}
+
+/**
+ * Replaces the string owned by the given pointer with a copy of str, similar to strset.
+ * Empty strings are stored as NULL. Returns false if the arena does not have enough room.
+ */
+static inline bool string_arena_strset(StringArena *arena, char **owner, const char *str) {
+  string_arena_free(arena, owner);
+  *owner = NULL;
+  if (!str || !str[0]) {
+    return true;
+  }
+  size_t length = strlen(str);
+  char *data = string_arena_alloc(arena, owner, length);
+  if (!data) {
+    return false;
+  }
+  memcpy(data, str, length + 1);
+  return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <pebble.h>
+
+static inline uint32_t get_time_ms(void) {
+  time_t seconds;
+  uint16_t milliseconds;
+  time_ms(&seconds, &milliseconds);
+  return seconds * 1000 + milliseconds;
+}